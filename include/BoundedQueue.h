@@ -0,0 +1,137 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Tamaño de línea de caché: separa contadores escritos por hilos distintos
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Cola acotada sin locks para varios productores y consumidores (algoritmo de
+// D. Vyukov). Cada celda lleva un número de secuencia que indica si está libre
+// para el productor de esa vuelta o lista para su consumidor; push y pop solo
+// compiten con un CAS sobre su propio índice. tryPush falla si la cola está llena
+// y tryPop si está vacía: la espera (y la contrapresión) queda a cargo del llamador.
+template <typename T>
+class BoundedQueue {
+public:
+    // La capacidad se redondea a la siguiente potencia de 2
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+        enqueuePos_.store(0, std::memory_order_relaxed);
+        dequeuePos_.store(0, std::memory_order_relaxed);
+    }
+
+    bool tryPush(const T &value) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // llena
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T &value) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // vacía
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Aproximado si hay operaciones en curso; sirve como condición de espera
+    bool empty() const {
+        size_t pos = dequeuePos_.load(std::memory_order_acquire);
+        size_t seq = cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+        return static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos_;
+};
+
+// Punto de espera para un hilo que depende de colas sin locks: primero reintenta
+// unas vueltas (los bloques suelen llegar enseguida) y luego se bloquea en una
+// variable de condición. notify() solo toma el mutex si hay alguien bloqueado.
+class Parker {
+public:
+    Parker() : sleepers_(0) {}
+
+    // Espera hasta que ready() sea true
+    template <typename Predicate>
+    void wait(Predicate ready) {
+        for (int i = 0; i < SPIN_ROUNDS; ++i) {
+            if (ready()) return;
+            if (i >= SPIN_ROUNDS / 2) std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        // Junto con el fence de notify(): o el notificador ve sleepers_ > 0 o esta
+        // evaluación de ready() ve el cambio que publicó, así que no se pierden avisos
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!ready()) cv_.wait(lock);
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Llamar después de publicar el cambio que puede satisfacer a quien espera
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+private:
+    static constexpr int SPIN_ROUNDS = 64;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<int> sleepers_;
+};
+
+#endif // BOUNDEDQUEUE_H
@@ -0,0 +1,161 @@
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Memoria para buffers: los pedidos grandes (>= 2 MB) se mapean alineados a huge page
+// con MADV_HUGEPAGE; los pequeños usan operator new
+void* allocateBufferMemory(size_t bytes);
+void releaseBufferMemory(void* p, size_t bytes);
+
+// Asignador de los buffers del pool. resize() no rellena con ceros: los códecs
+// siempre escriben antes de leer, así que agrandar un buffer reutilizado es gratis.
+template <typename T>
+struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(allocateBufferMemory(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { releaseBufferMemory(p, n * sizeof(T)); }
+
+    template <typename U>
+    void construct(U* p) { ::new (static_cast<void*>(p)) U; }
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) { ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
+
+using ByteBuffer = std::vector<uint8_t, PoolAllocator<uint8_t>>;
+
+// Arena de memoria: asigna avanzando un puntero dentro de bloques grandes obtenidos
+// con mmap (marcados con MADV_HUGEPAGE). No hay liberación individual: rewind()
+// devuelve de una vez todo lo asignado desde una marca, y los bloques se conservan
+// para la siguiente tarea, así que sus páginas ya están mapeadas.
+class Arena {
+public:
+    struct Marker {
+        size_t block;
+        size_t offset;
+    };
+
+    Arena() = default;
+    ~Arena();
+
+    // Retorna memoria sin inicializar alineada a 'align' (potencia de 2)
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    // Espacio para 'count' objetos de tipo T (trivial), sin construirlos
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    Marker mark() const { return {current_, offset_}; }
+
+    // Libera todo lo asignado después de 'marker' (las marcas se deben respetar en orden LIFO)
+    void rewind(const Marker &marker);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+private:
+    struct Block {
+        uint8_t* data;
+        size_t size;
+    };
+    std::vector<Block> blocks_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+};
+
+// Pool de buffers y arena de un hilo. Los códecs piden buffers con acquire() y los
+// devuelven con release() (o mediante PooledBuffer), de modo que al procesar muchos
+// archivos pequeños se reutiliza la misma memoria en lugar de llamar a malloc/free.
+// No es thread-safe: cada hilo usa su propio pool.
+class BufferPool {
+public:
+    BufferPool();
+
+    // Buffer vacío con capacidad para al menos 'capacity' bytes
+    ByteBuffer acquire(size_t capacity);
+
+    // Devuelve un buffer al pool; si el pool está lleno se libera
+    void release(ByteBuffer &&buffer);
+
+    // Arena para tablas y estructuras que viven lo que dura una tarea
+    Arena& arena() { return arena_; }
+
+    // Pool asociado al hilo actual (el de un BufferPoolScope activo o uno propio del hilo)
+    static BufferPool& current();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+private:
+    std::vector<ByteBuffer> free_;
+    size_t cachedBytes_;
+    Arena arena_;
+};
+
+// Asocia 'pool' al hilo actual mientras exista. Al destruirse libera lo que se
+// asignó en la arena durante su vida y restaura el pool anterior.
+class BufferPoolScope {
+public:
+    explicit BufferPoolScope(BufferPool &pool);
+    ~BufferPoolScope();
+
+    BufferPoolScope(const BufferPoolScope&) = delete;
+    BufferPoolScope& operator=(const BufferPoolScope&) = delete;
+
+private:
+    BufferPool &pool_;
+    BufferPool* previous_;
+    Arena::Marker mark_;
+};
+
+// Buffer tomado del pool actual (vacío, con la capacidad pedida) que se devuelve
+// automáticamente al destruirse
+class PooledBuffer {
+public:
+    explicit PooledBuffer(size_t capacity) : pool_(BufferPool::current()), buffer_(pool_.acquire(capacity)) {}
+    ~PooledBuffer() { pool_.release(std::move(buffer_)); }
+
+    ByteBuffer& operator*() { return buffer_; }
+    ByteBuffer* operator->() { return &buffer_; }
+    const ByteBuffer* operator->() const { return &buffer_; }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+private:
+    BufferPool &pool_;
+    ByteBuffer buffer_;
+};
+
+// Memoria de un hilo worker: un BufferPool por etapa del pipeline, para que las
+// etapas de un mismo archivo (que corren en hilos distintos) no compartan pool.
+// Se conserva entre archivos, así que un worker reutiliza sus buffers y su arena.
+class WorkerMemory {
+public:
+    BufferPool& stage(size_t index);
+
+    // Memoria del hilo actual
+    static WorkerMemory& local();
+
+private:
+    std::vector<std::unique_ptr<BufferPool>> stages_;
+};
+
+#endif // BUFFERPOOL_H
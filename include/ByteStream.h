@@ -0,0 +1,206 @@
+#ifndef BYTESTREAM_H
+#define BYTESTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "fileManager.h"
+
+// Origen de bytes secuencial (archivo, mmap, memoria o pipe)
+class ByteSource {
+public:
+    virtual ~ByteSource() = default;
+
+    // Lee hasta 'size' bytes. Retorna los bytes leídos, 0 en EOF o -1 si falla.
+    virtual ssize_t read(void* buffer, size_t size) = 0;
+
+    // Lee hasta completar 'size' bytes o llegar a EOF
+    ssize_t readFull(void* buffer, size_t size);
+
+    // Tamaño total si se conoce de antemano; -1 si no (pipes, stdin)
+    virtual long long size() const { return -1; }
+
+    // Vista contigua de lo que queda por leer (mmap o memoria), de dataSize() bytes, o
+    // nullptr si no existe. Permite a los consumidores procesar los datos sin copiarlos
+    // a un buffer; tras leer una cabecera con read() la vista empieza después de ella.
+    virtual const uint8_t* data() const { return nullptr; }
+    virtual size_t dataSize() const { return 0; }
+
+    // Descriptor de un archivo regular posicionado al inicio (para lecturas pread
+    // en paralelo); -1 si el origen no es un archivo regular
+    virtual int fd() const { return -1; }
+};
+
+// Destino de bytes secuencial
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+
+    // Escribe los 'size' bytes completos. Retorna size o -1 si falla.
+    virtual ssize_t write(const void* buffer, size_t size) = 0;
+
+    // Descriptor de un archivo regular vacío (para escrituras pwrite en paralelo); -1 si no aplica
+    virtual int fd() const { return -1; }
+};
+
+// --- Descriptores de archivo ---
+
+class FdSource : public ByteSource {
+public:
+    // Si 'owned' es true, el descriptor se cierra al destruir el objeto
+    explicit FdSource(int fd, bool owned = false) : fd_(fd), owned_(owned), pos_(0) {}
+    ~FdSource() override { close(); }
+
+    ssize_t read(void* buffer, size_t size) override;
+    long long size() const override;
+    int fd() const override;
+
+    // Cierra el descriptor si es propio (idempotente)
+    void close();
+
+    FdSource(const FdSource&) = delete;
+    FdSource& operator=(const FdSource&) = delete;
+
+protected:
+    int fd_;
+    bool owned_;
+    long long pos_;     // Bytes transferidos (para --direct-io)
+};
+
+class FdSink : public ByteSink {
+public:
+    explicit FdSink(int fd, bool owned = false) : fd_(fd), owned_(owned), pos_(0) {}
+    ~FdSink() override { close(); }
+
+    ssize_t write(const void* buffer, size_t size) override;
+    int fd() const override;
+
+    // Cierra el descriptor si es propio (idempotente); en un pipe señala EOF al lector
+    void close();
+
+    FdSink(const FdSink&) = delete;
+    FdSink& operator=(const FdSink&) = delete;
+
+protected:
+    int fd_;
+    bool owned_;
+    long long pos_;     // Bytes transferidos (para --direct-io)
+};
+
+// --- Archivo mapeado en memoria (solo lectura) ---
+
+class MmapSource : public ByteSource {
+public:
+    // Mapea el archivo completo del descriptor (que no se cierra). Si el mapeo falla,
+    // valid() es false y el llamador debe usar FdSource.
+    explicit MmapSource(int fd);
+    ~MmapSource() override;
+
+    bool valid() const { return valid_; }
+
+    ssize_t read(void* buffer, size_t size) override;
+    long long size() const override { return static_cast<long long>(view_.size); }
+    const uint8_t* data() const override { return view_.data ? view_.data + pos_ : nullptr; }
+    size_t dataSize() const override { return view_.size - pos_; }
+    int fd() const override { return pos_ == 0 ? fd_ : -1; }
+
+    MmapSource(const MmapSource&) = delete;
+    MmapSource& operator=(const MmapSource&) = delete;
+
+private:
+    int fd_;
+    MappedFile view_;
+    size_t pos_;
+    bool valid_;
+};
+
+// --- Buffers en memoria ---
+
+class MemorySource : public ByteSource {
+public:
+    MemorySource(const void* data, size_t size)
+        : data_(static_cast<const uint8_t*>(data)), size_(size), pos_(0) {}
+
+    ssize_t read(void* buffer, size_t size) override;
+    long long size() const override { return static_cast<long long>(size_); }
+    const uint8_t* data() const override { return data_ ? data_ + pos_ : nullptr; }
+    size_t dataSize() const override { return size_ - pos_; }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+};
+
+class MemorySink : public ByteSink {
+public:
+    // Agrega los bytes escritos al final de 'out'
+    explicit MemorySink(std::vector<uint8_t> &out) : out_(out) {}
+
+    ssize_t write(const void* buffer, size_t size) override;
+
+private:
+    std::vector<uint8_t> &out_;
+};
+
+// --- Contadores ---
+// Envuelven otro origen/destino y cuentan los bytes que pasan por ellos (útil para
+// stdin/stdout, cuyo tamaño no puede consultarse con stat). No exponen data() ni fd()
+// para que todo el tráfico pase por read()/write().
+
+class CountingSource : public ByteSource {
+public:
+    explicit CountingSource(ByteSource &inner) : inner_(inner), count_(0) {}
+
+    ssize_t read(void* buffer, size_t size) override;
+    long long size() const override { return inner_.size(); }
+    long long count() const { return count_; }
+
+private:
+    ByteSource &inner_;
+    long long count_;
+};
+
+class CountingSink : public ByteSink {
+public:
+    explicit CountingSink(ByteSink &inner) : inner_(inner), count_(0) {}
+
+    ssize_t write(const void* buffer, size_t size) override;
+    long long count() const { return count_; }
+
+private:
+    ByteSink &inner_;
+    long long count_;
+};
+
+// --- Pipes ---
+// Extremos de un pipe del kernel (capacidad acotada) que se cierran al destruirse.
+// Sirven para conectar etapas que corren en hilos distintos.
+
+class PipeSource : public FdSource {
+public:
+    explicit PipeSource(int fd) : FdSource(fd, true) {}
+};
+
+class PipeSink : public FdSink {
+public:
+    explicit PipeSink(int fd) : FdSink(fd, true) {}
+};
+
+// Crea un pipe e intenta ampliar su capacidad a 'capacity' bytes. Retorna false si falla.
+bool createPipe(std::unique_ptr<PipeSource> &source, std::unique_ptr<PipeSink> &sink, size_t capacity);
+
+// Abre entrada (mapeada en memoria si es un archivo regular) y salida (ver OutputFile:
+// aparece en outputPath solo si transform tuvo éxito), aplica transform(source, sink)
+// y cierra ambos. Retorna false si algo falla.
+// La ruta "-" usa stdin como entrada o stdout como salida. Si se conoce el tamaño que
+// tendrá la salida ('outputSizeHint' > 0), se reserva al abrirla y el sobrante se libera al final.
+bool transformFile(const std::string &inputPath, const std::string &outputPath,
+                   const std::function<bool(ByteSource&, ByteSink&)> &transform,
+                   long long outputSizeHint = 0);
+
+#endif // BYTESTREAM_H
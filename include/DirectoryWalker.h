@@ -0,0 +1,41 @@
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Archivo encontrado por el recorrido, con la ruta de su salida y su tamaño
+struct WalkEntry {
+    std::string inputPath;
+    std::string outputPath;
+    long long size;         // -1 si no pudo consultarse
+    long long mtimeNs;      // Última modificación (ns desde epoch); 0 si no se conoce
+    uint64_t inode;
+};
+
+// Recorre un árbol de entrada y replica su estructura de carpetas en el de salida.
+// Cada subcarpeta es una tarea de un pool propio, así los subárboles se recorren en
+// paralelo. Por entrada se usa el tipo que trae readdir (d_type) y fstatat relativo
+// al descriptor de la carpeta (sin resolver la ruta completa); solo los enlaces
+// simbólicos y los sistemas de archivos sin d_type necesitan resolver el tipo aparte.
+// Cada carpeta de salida se crea una sola vez, al visitar la de entrada (su padre
+// ya existe), en lugar de verificar la ruta completa por cada archivo.
+class DirectoryWalker {
+public:
+    // Se llama una vez por archivo, desde los hilos del recorrido (en paralelo)
+    using Visitor = std::function<void(WalkEntry &&entry)>;
+
+    // Si threads es 0 se usan las CPUs disponibles (mínimo 4: el recorrido espera al disco)
+    explicit DirectoryWalker(size_t threads = 0);
+
+    // Recorre 'inputRoot' (o lo entrega tal cual si no es una carpeta) y retorna al
+    // terminar. Retorna la cantidad de archivos entregados a 'visit'.
+    size_t walk(const std::string &inputRoot, const std::string &outputRoot, const Visitor &visit);
+
+private:
+    size_t threads_;
+};
+
+#endif // DIRECTORYWALKER_H
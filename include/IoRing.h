@@ -0,0 +1,72 @@
+#ifndef IORING_H
+#define IORING_H
+
+#include <sys/uio.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Cola de E/S asíncrona sobre io_uring (con las llamadas al sistema directamente,
+// sin liburing). Las lecturas y escrituras se preparan en la cola de envío, se
+// entregan al kernel en lote con submit() y sus resultados se recogen con
+// popCompletion(). No es thread-safe: cada hilo usa su propia cola.
+// Si el kernel no soporta io_uring (o seccomp lo bloquea), o es anterior a 5.6 y no
+// tiene las operaciones READ/WRITE, available() es false y el llamador debe usar
+// read()/write().
+class IoRing {
+public:
+    explicit IoRing(unsigned entries = 64);
+    ~IoRing();
+
+    bool available() const { return fd_ >= 0; }
+
+    // Registra buffers fijos: las operaciones con bufferIndex >= 0 evitan que el
+    // kernel mapee las páginas en cada llamada. Retorna false si no se pudo (p. ej.
+    // por RLIMIT_MEMLOCK); las operaciones sin índice siguen funcionando.
+    bool registerBuffers(const std::vector<iovec> &buffers);
+
+    // Preparan una operación en 'offset'. 'userData' identifica la operación en su
+    // resultado. Retornan false si la cola está llena (hay que enviar y recoger antes).
+    bool prepareRead(int fd, void* buffer, unsigned len, long long offset, uint64_t userData, int bufferIndex = -1);
+    bool prepareWrite(int fd, const void* buffer, unsigned len, long long offset, uint64_t userData, int bufferIndex = -1);
+
+    // Entrega al kernel las operaciones preparadas; si waitFor > 0 espera hasta que
+    // haya al menos esa cantidad de resultados. Retorna false si io_uring_enter falla.
+    bool submit(unsigned waitFor = 0);
+
+    // Toma un resultado: 'result' es lo que retornaría read()/write() o -errno
+    bool popCompletion(uint64_t &userData, int &result);
+
+    // Operaciones enviadas o preparadas cuyo resultado aún no se tomó
+    unsigned inFlight() const { return inFlight_; }
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+private:
+    int fd_;
+    unsigned entries_;
+    unsigned toSubmit_;
+    unsigned inFlight_;
+    bool fixedBuffers_;
+
+    void* sqRing_;
+    size_t sqRingSize_;
+    void* cqRing_;
+    size_t cqRingSize_;
+    void* sqes_;
+    size_t sqesSize_;
+
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqMask_;
+    unsigned* sqArray_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned* cqMask_;
+    void* cqes_;
+
+    bool prepare(int opcode, int fd, const void* buffer, unsigned len, long long offset, uint64_t userData, int bufferIndex);
+};
+
+#endif // IORING_H
@@ -12,6 +12,10 @@ private:
     std::ofstream logFile;
     std::mutex writeMutex;
     std::chrono::steady_clock::time_point startTime;
+    bool directory;
+    // Posición de los totales del encabezado que se completan al final (-1 si no hay)
+    std::streampos totalFilesPos;
+    std::streampos totalSizePos;
     
     // Obtiene timestamp formateado
     std::string getCurrentTimestamp();
@@ -26,11 +30,16 @@ public:
     // Destructor: cierra el archivo
     ~Journal();
     
-    // Escribe el encabezado inicial del journal
+    // Escribe el encabezado inicial del journal. En una carpeta, totalFiles < 0 indica
+    // que los totales aún no se conocen (el recorrido sigue): quedan reservados en el
+    // encabezado y se completan con finalizeTotals
     void writeHeader(const std::string& operation, const std::string& targetPath, 
                      const std::string& sourcePath = "", const std::string& destPath = "",
                      int totalFiles = 1, long long totalSize = 0);
     
+    // Completa los totales reservados por writeHeader
+    void finalizeTotals(int totalFiles, long long totalSize);
+    
     // Escribe una entrada de log con timestamp
     void log(const std::string& message);
     
@@ -0,0 +1,102 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include "DirectoryWalker.h"
+#include "fileManager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Manifiesto del modo --incremental: por cada archivo de entrada procesado con éxito
+// guarda su ruta (relativa a la carpeta de entrada), tamaño, mtime e inode, el tamaño
+// de la salida y, opcionalmente, un hash rápido del contenido. Se guarda junto al árbol
+// de salida ("<salida>.manifest") y se mapea en memoria: las entradas están ordenadas
+// por el hash de la ruta, así que cada consulta es una búsqueda binaria sin leer ni
+// parsear el archivo completo. Una corrida que no cambió nada solo recorre el árbol.
+//
+// Formato (enteros de 64 bits en el orden de bytes de la máquina):
+//   encabezado (32 bytes): "FUMANIF1", hash de la configuración, cantidad, sal de la clave
+//   entradas (64 bytes c/u), ordenadas por pathHash y luego por ruta
+//   rutas concatenadas (sin terminador; cada entrada guarda su desplazamiento y largo)
+class Manifest {
+public:
+    // Abre el manifiesto de 'outputRoot' si existe y se generó con la misma
+    // configuración (operaciones, algoritmos y 'key'); si no, todos los archivos cuentan
+    // como cambiados. De la clave solo se guarda un valor derivado con una sal aleatoria
+    // por manifiesto y AES encadenado (lento de invertir por fuerza bruta), nunca la clave. Con 'useHash', un archivo con otro mtime pero el mismo
+    // contenido (mismo tamaño, inode y hash) también se omite.
+    Manifest(const std::string &inputRoot, const std::string &outputRoot,
+             const std::string &config, const std::string &key, bool useHash);
+    ~Manifest();
+
+    // Ruta del manifiesto de un árbol de salida
+    static std::string pathFor(const std::string &outputRoot);
+
+    // Si el archivo no cambió desde la corrida anterior (y su salida sigue ahí) lo
+    // registra para el nuevo manifiesto y retorna true: no hace falta procesarlo. Si no,
+    // lo deja pendiente hasta finish. Thread-safe (lo llaman los hilos del recorrido).
+    bool unchanged(const WalkEntry &entry);
+
+    // El archivo pendiente terminó; solo los exitosos quedan en el nuevo manifiesto
+    // (los fallidos se reintentan en la próxima corrida). Thread-safe.
+    void finish(const std::string &inputPath, bool ok);
+
+    // Escribe el nuevo manifiesto (de forma atómica, ver OutputFile). Retorna false si falla.
+    bool save();
+
+    // Archivos omitidos por no haber cambiado
+    size_t skipped() const { return skipped_; }
+
+    Manifest(const Manifest&) = delete;
+    Manifest& operator=(const Manifest&) = delete;
+
+    struct Entry {
+        uint64_t pathHash;
+        uint64_t pathOffset;
+        uint64_t pathLength;
+        uint64_t size;
+        int64_t mtimeNs;
+        uint64_t inode;
+        uint64_t contentHash;   // 0 si no se calculó
+        uint64_t outputSize;
+    };
+
+private:
+    struct Record {
+        std::string path;       // relativa a la carpeta de entrada
+        Entry meta;
+        std::string outputPath; // solo mientras está pendiente
+    };
+
+    // Entrada de la corrida anterior para 'relPath' o nullptr
+    const Entry* find(const std::string &relPath, uint64_t hash) const;
+    std::string relativePath(const std::string &inputPath) const;
+
+    std::string inputRoot_;
+    std::string path_;
+    uint64_t config_;
+    uint64_t salt_;
+    bool useHash_;
+
+    // Manifiesto anterior (mapeado)
+    MappedFile view_;
+    const Entry* entries_ = nullptr;
+    size_t count_ = 0;
+    const char* strings_ = nullptr;
+    size_t stringsSize_ = 0;
+
+    // Nuevo manifiesto y archivos en curso (por ruta de entrada)
+    std::mutex mutex_;
+    std::vector<Record> records_;
+    std::unordered_map<std::string, Record> pending_;
+    size_t skipped_ = 0;
+};
+
+// Hash rápido (no criptográfico) de 64 bits de un bloque de memoria
+uint64_t fastHash64(const void* data, size_t size);
+
+#endif // MANIFEST_H
@@ -0,0 +1,145 @@
+#ifndef STAGEDEXECUTOR_H
+#define STAGEDEXECUTOR_H
+
+#include "ByteStream.h"
+#include "BufferPool.h"
+#include "BoundedQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Ejecutor por etapas: un hilo lector, N hilos de cómputo y un hilo escritor
+// conectados por colas acotadas sin locks (BoundedQueue) que transportan bloques
+// grandes. Mientras los hilos de cómputo procesan, el lector ya trae los siguientes
+// bloques y el escritor vacía los anteriores, así que disco y CPU trabajan a la vez.
+// Las colas llenas bloquean al productor (contrapresión), lo que acota la memoria.
+class StagedExecutor {
+public:
+    // Si computeThreads es 0 se usa ThreadPool::defaultThreadCount(). Los hilos de
+    // cómputo se fijan a las CPUs de los workers (ver cpuAffinity.h).
+    explicit StagedExecutor(size_t computeThreads = 0);
+
+    // Número de hilos de cómputo
+    size_t getThreadCount() const { return computeThreads_; }
+
+    // Ajuste automático de la concurrencia en runFiles: mide el throughput y la
+    // utilización de los workers y sube o baja cuántos toman archivos nuevos
+    // (hill-climbing) entre 1 y getThreadCount()
+    void setAdaptive(bool adaptive) { adaptive_ = adaptive; }
+
+    // Hilos de cómputo que usó el último runFiles (con ajuste automático, el nivel
+    // al que llegó el controlador)
+    size_t getChosenThreadCount() const { return chosenThreads_; }
+
+    // --- Archivos completos ---
+
+    struct FileTask {
+        std::string inputPath;
+        std::string outputPath;
+        // Si es true, el trabajo recibe source/sink nulos y abre las rutas por su cuenta
+        // (archivos grandes que se procesan con mmap y trozos en paralelo, stdin/stdout)
+        bool direct;
+        // Tamaño estimado de la salida; si es > 0 el escritor la reserva al abrirla
+        long long outputSizeHint = 0;
+        // Tamaño de la entrada (-1 si no se conoce): la cola entrega primero los más grandes
+        long long inputSize = -1;
+    };
+
+    // Cola acotada de archivos por procesar. Un productor (el recorrido de una carpeta)
+    // la llena mientras runFiles ya la consume, así el cómputo empieza con los primeros
+    // archivos sin esperar a conocer el árbol completo. push espera si la cola está
+    // llena: solo las tareas pendientes y en curso ocupan memoria. Entre las pendientes
+    // (hasta 'capacity') sale primero la más grande, así un archivo grande no queda
+    // solo en un hilo al final de la corrida.
+    class FileQueue {
+    public:
+        explicit FileQueue(size_t capacity = 4096);
+        ~FileQueue();
+
+        // Agrega una tarea; espera si la cola está llena. Thread-safe.
+        void push(FileTask task);
+
+        // No habrá más tareas (la llama el productor al terminar)
+        void close();
+
+        // Espera hasta que haya una tarea o la cola se cierre. false si se cerró vacía.
+        bool waitForTask();
+
+        FileQueue(const FileQueue&) = delete;
+        FileQueue& operator=(const FileQueue&) = delete;
+
+    private:
+        friend class StagedExecutor;
+
+        struct Pending {
+            long long size;
+            size_t order;  // orden de llegada: entre iguales, el primero
+            FileTask* task;
+        };
+        static bool pendingLess(const Pending &a, const Pending &b);
+
+        bool tryPop(FileTask* &task);
+        bool empty() const { return count_.load() == 0; }
+        // Cerrada y sin tareas pendientes
+        bool drained() const;
+
+        const size_t capacity_;
+        std::mutex mutex_;
+        std::vector<Pending> heap_;         // montículo por tamaño: el más grande arriba
+        std::atomic<size_t> count_;         // heap_.size(), para consultarlo sin el mutex
+        std::atomic<size_t> pushed_;
+        std::atomic<bool> closed_;
+        Parker spaceParker_;                // productores: espera por lugar
+        Parker taskParker_;                 // waitForTask
+        std::atomic<Parker*> consumer_;     // lector de runFiles, si está corriendo
+    };
+
+    // Corre en un hilo de cómputo: lee de 'source' (bloques que trae el lector) y escribe
+    // en 'sink' (bloques que guarda el escritor). Retorna false si el procesamiento falla.
+    using FileJob = std::function<bool(const FileTask &task, ByteSource* source, ByteSink* sink)>;
+
+    // Resultado final de un archivo: true si el trabajo tuvo éxito y además su salida se
+    // pudo escribir y publicar por completo. Se llama desde los hilos del ejecutor.
+    using FileDone = std::function<void(const FileTask &task, bool ok)>;
+
+    // Procesa los archivos de 'queue' a medida que llegan, hasta que se cierre y se vacíe.
+    // Los grandes (direct) los toman los hilos de cómputo en cuanto llegan; el resto
+    // pasa por el lector y el escritor.
+    void runFiles(FileQueue &queue, const FileJob &job, const FileDone &done);
+
+    // --- Bloques independientes de un archivo grande ---
+
+    struct BlockTask {
+        // Hilo lector: obtiene el bloque i (en 'buffer' o directamente de un mapeo);
+        // nullptr si la lectura falla
+        std::function<const uint8_t*(size_t index, ByteBuffer &buffer)> read;
+        // Hilos de cómputo: procesa el bloque; lo que deje en 'output' se escribe
+        std::function<bool(size_t index, const uint8_t* input, ByteBuffer &output)> compute;
+        // Hilo escritor: guarda la salida del bloque i (se llama en orden de índice,
+        // así que puede escribir en un flujo secuencial); vacío si no hay salida
+        std::function<bool(size_t index, const uint8_t* data, size_t len)> write;
+    };
+
+    // Procesa los bloques 0..count-1: lee en el hilo que llama, calcula en el
+    // ThreadPool compartido y escribe en un hilo propio. Retorna false si alguna etapa falla.
+    // No debe llamarse desde una tarea del ThreadPool compartido.
+    static bool runBlocks(size_t count, const BlockTask &task);
+
+    // Workers del ThreadPool compartido que ocupan ahora los runBlocks en curso. runFiles
+    // los descuenta de sus hilos de cómputo: archivos grandes y pequeños comparten el
+    // mismo presupuesto de CPUs en lugar de sumar el doble de hilos.
+    static size_t blockWorkersInUse();
+
+private:
+    size_t computeThreads_;
+    bool adaptive_;
+    size_t chosenThreads_;
+};
+
+#endif // STAGEDEXECUTOR_H
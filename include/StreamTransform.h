@@ -0,0 +1,49 @@
+#ifndef STREAMTRANSFORM_H
+#define STREAMTRANSFORM_H
+
+#include "ByteStream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Transformación incremental: recibe la entrada en trozos de cualquier tamaño
+// (incluso de 1 byte) y emite la salida en un ByteSink a medida que la produce.
+// Los códecs y cifrados se implementan sobre esta interfaz.
+class StreamTransform {
+public:
+    virtual ~StreamTransform() = default;
+
+    // Procesa el siguiente trozo de entrada. Retorna false si falla (datos inválidos o error de escritura).
+    virtual bool update(const uint8_t* data, size_t len, ByteSink &sink) = 0;
+
+    // Fin de la entrada: emite lo pendiente (padding, último bloque, etc.)
+    virtual bool finish(ByteSink &sink) = 0;
+};
+
+// Adaptador que convierte una transformación en un ByteSink: lo que se escribe en él
+// se transforma y se envía a 'next'. Permite encadenar transformaciones en un solo hilo
+// sin buffers intermedios.
+class TransformSink : public ByteSink {
+public:
+    TransformSink(StreamTransform &transform, ByteSink &next) : transform_(transform), next_(next) {}
+
+    ssize_t write(const void* buffer, size_t size) override;
+
+    // Propaga el fin de datos a la transformación
+    bool finish() { return transform_.finish(next_); }
+
+private:
+    StreamTransform &transform_;
+    ByteSink &next_;
+};
+
+// Lee todo 'source', lo pasa por 'transform' y escribe en 'sink'. Si el origen
+// ofrece una vista contigua (mmap o memoria) se procesa sin copias intermedias.
+bool runTransform(ByteSource &source, StreamTransform &transform, ByteSink &sink);
+
+// Igual que runTransform pero con varias transformaciones encadenadas en el hilo actual
+bool runTransformChain(ByteSource &source, const std::vector<StreamTransform*> &transforms, ByteSink &sink);
+
+#endif // STREAMTRANSFORM_H
@@ -4,16 +4,34 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
+#include <deque>
 #include <functional>
+#include <future>
+#include <memory>
 #include <vector>
 #include <atomic>
+#include "BoundedQueue.h"        // CACHE_LINE_SIZE y Parker
+#include "WorkStealingDeque.h"
 
-// Clase para un pool de hilos que ejecuta tareas en paralelo
+class TaskGroup;
+
+// Clase para un pool de hilos que ejecuta tareas en paralelo. Hay dos colas de tareas:
+// - WorkStealing: cada worker tiene su propio deque (Chase–Lev); las tareas que encola
+//   un worker van a su deque sin locks, y un worker sin trabajo roba de los demás
+//   empezando por una víctima al azar. Las tareas que llegan desde fuera del pool se
+//   reparten round-robin entre buzones por worker.
+// - SharedRing: una única cola MPMC acotada sin locks (BoundedQueue) para todos. Si se
+//   llena, quien encola espera (o, si es un worker, ejecuta la tarea él mismo).
+// La cola por defecto se elige al compilar (make POOL_QUEUE=ring) y puede cambiarse
+// en tiempo de ejecución con setDefaultQueueKind() antes de crear el pool.
+// Los workers no se fijan a una CPU: con setWorkerCpus (cpuAffinity.h) corren en el
+// conjunto del proceso, y las CPUs individuales quedan para los workers de runFiles.
 class ThreadPool {
 public:
+    enum class QueueKind { WorkStealing, SharedRing };
+
     // Constructor que inicia el pool con numThreads hilos
-    explicit ThreadPool(size_t numThreads = 0);
+    explicit ThreadPool(size_t numThreads = 0, QueueKind kind = defaultQueueKind());
 
     // Destructor que detiene el pool y une los hilos
     ~ThreadPool();
@@ -21,26 +39,117 @@ public:
     // Encola una nueva tarea en el pool
     void enqueue(std::function<void()> task);
 
+    // Encola una tarea y retorna un future con su resultado (o su excepción)
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())> {
+        using R = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::move(task));
+        std::future<R> result = packaged->get_future();
+        enqueue([packaged] { (*packaged)(); });
+        return result;
+    }
+
     // Espera a que todas las tareas encoladas se completen
     void waitForCompletion();
 
     // Obtiene el número de hilos en el pool
     size_t getThreadCount() const { return workers.size(); }
 
+    // Cola de tareas que usa este pool
+    QueueKind getQueueKind() const { return kind; }
+
+    // Pool compartido del proceso (hardware_concurrency hilos), creado en el primer uso
+    static ThreadPool& shared();
+
+    // Cola para los pools que se creen sin indicarla (incluido shared())
+    static QueueKind defaultQueueKind();
+    static void setDefaultQueueKind(QueueKind kind);
+
+    // Hilos para los pools que se creen con numThreads = 0 (incluido shared()).
+    // Sin configurar: las CPUs disponibles para el proceso.
+    static size_t defaultThreadCount();
+    static void setDefaultThreadCount(size_t count);
+
     // Deshabilitar copia y asignación
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool& operator=(const ThreadPool&) = delete;
 
 private:
-    std::vector<std::thread> workers;           // Hilos worker
-    std::queue<std::function<void()>> tasks;    // Cola de tareas
-    std::mutex queueMutex;                      // Mutex para la cola
-    std::condition_variable condition;           // Variable de condición
-    std::atomic<bool> stop;                     // Flag para detener el pool
-    std::atomic<size_t> activeTasks;            // Contador de tareas activas
+    using Task = std::function<void()>;
+
+    // Colas de un worker, alineadas para que dos workers no compartan línea de caché
+    struct alignas(CACHE_LINE_SIZE) WorkerQueues {
+        WorkStealingDeque<Task> local;        // Tareas encoladas por el propio worker
+        std::mutex inboxMutex;                // Protege inbox
+        std::deque<Task*> inbox;              // Tareas encoladas desde fuera del pool
+        std::atomic<size_t> inboxSize{0};     // Permite mirar el buzón sin tomar el lock
+    };
+
+    QueueKind kind;                                         // Cola de tareas en uso
+    std::vector<std::thread> workers;                       // Hilos worker
+    std::vector<std::unique_ptr<WorkerQueues>> queues;      // Colas por worker (WorkStealing)
+    std::unique_ptr<BoundedQueue<Task*>> ring;              // Cola compartida (SharedRing)
+    Parker ringNotFull;                                     // Productores esperando lugar en ring
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> pending;   // Tareas encoladas que nadie tomó aún
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> activeTasks; // Contador de tareas activas
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> nextInbox; // Reparto round-robin de tareas externas
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> stop;        // Flag para detener el pool
+    Parker idle;                                            // Workers sin trabajo
+    std::mutex doneMutex;                                   // Para waitForCompletion
+    std::condition_variable doneCondition;                  // Se avisa cuando activeTasks llega a 0
 
     // Hilo worker que procesa tareas de la cola
-    void workerThread();
+    void workerThread(size_t index);
+
+    // Busca trabajo: deque propio, buzón propio y luego robo a los demás
+    Task* findTask(size_t index, uint64_t &rng);
+
+    static Task* popInbox(WorkerQueues &q);
+
+    // Ejecuta la tarea capturando excepciones y la libera
+    static void runTask(Task* task);
+
+    // Descuenta una tarea terminada y avisa a waitForCompletion si era la última
+    void finishTask();
+
+    // Si el hilo actual es worker de este pool, ejecuta una tarea pendiente (si hay)
+    bool runPendingTask();
+
+    friend class TaskGroup;
+};
+
+// Grupo de tareas de un pool: permite esperar solo a ese subconjunto y declarar
+// dependencias entre tareas, que se ejecutan como un grafo acíclico (una tarea se
+// encola cuando terminan todas las que declaró como dependencias).
+class TaskGroup {
+public:
+    struct Node;
+    // Referencia a una tarea del grupo, para usarla como dependencia de otras
+    using TaskRef = std::shared_ptr<Node>;
+
+    explicit TaskGroup(ThreadPool &pool = ThreadPool::shared());
+
+    // Espera a las tareas que queden
+    ~TaskGroup();
+
+    // Agrega una tarea que corre cuando terminan todas las de 'dependencies'
+    TaskRef run(std::function<void()> task, const std::vector<TaskRef> &dependencies = {});
+
+    // Espera a que terminen todas las tareas del grupo. Desde un worker del mismo pool
+    // ejecuta tareas pendientes mientras espera, así que no lo bloquea.
+    void wait();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+private:
+    ThreadPool &pool_;
+    std::mutex mutex_;
+    std::condition_variable changed_;   // Termina una tarea del grupo
+    size_t outstanding_;                // Tareas agregadas sin terminar (protegido por mutex_)
+
+    void schedule(const TaskRef &node);
+    void complete(const TaskRef &node);
 };
 
 #endif // THREADPOOL_H
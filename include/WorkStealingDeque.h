@@ -0,0 +1,110 @@
+#ifndef WORKSTEALINGDEQUE_H
+#define WORKSTEALINGDEQUE_H
+
+#include "BoundedQueue.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Deque de Chase–Lev (versión C11 de Lê et al.) para punteros. Solo el hilo dueño
+// llama a push() y take() sobre el extremo inferior, sin locks ni CAS salvo cuando
+// compite por el último elemento; los demás hilos roban del extremo superior con
+// steal(). El arreglo crece al llenarse; los anteriores se liberan al destruir el deque
+// porque un ladrón puede estar leyéndolos todavía.
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity = 256) : top_(0), bottom_(0) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        arrays_.emplace_back(new Array(size));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    // Solo el dueño
+    void push(T* item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->mask)) a = grow(a, t, b);
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Solo el dueño: el último elemento agregado, o nullptr si está vacío
+    T* take() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = a->get(b);
+        if (t == b) {
+            // Último elemento: se lo disputa con los ladrones
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Cualquier hilo: el elemento más antiguo, o nullptr si está vacío o perdió la carrera
+    T* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return nullptr;
+        Array* a = array_.load(std::memory_order_acquire);
+        T* item = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // Aproximado si hay operaciones en curso
+    bool empty() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return t >= b;
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+private:
+    struct Array {
+        explicit Array(size_t size) : mask(size - 1), slots(new std::atomic<T*>[size]) {}
+
+        T* get(int64_t i) const { return slots[static_cast<size_t>(i) & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T* item) { slots[static_cast<size_t>(i) & mask].store(item, std::memory_order_relaxed); }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        arrays_.emplace_back(new Array((old->mask + 1) * 2));
+        Array* a = arrays_.back().get();
+        for (int64_t i = t; i < b; ++i) a->put(i, old->get(i));
+        array_.store(a, std::memory_order_release);
+        return a;
+    }
+
+    // top_ lo escriben los ladrones y bottom_ el dueño: cada uno en su línea de caché
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top_;
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom_;
+    alignas(CACHE_LINE_SIZE) std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_; // solo el dueño lo modifica (en grow)
+};
+
+#endif // WORKSTEALINGDEQUE_H
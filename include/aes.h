@@ -0,0 +1,32 @@
+#ifndef AES_H
+#define AES_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Implementaciones disponibles del núcleo AES-128
+enum class AesBackend {
+    Bitsliced,  // Bitsliced SSE2 de tiempo constante, 8 bloques en paralelo
+    AesNi       // Instrucciones AES-NI
+};
+
+// Clave expandida lista para cualquiera de los backends
+struct AesKey {
+    uint8_t roundKeys[176];                     // 11 round keys en formato estándar
+    alignas(16) uint64_t bitslicedKeys[11 * 16]; // Round keys en representación bitsliced
+    AesBackend backend;
+};
+
+// Detecta el mejor backend para la CPU actual (AES-NI si existe, si no bitsliced)
+AesBackend aesDetectBackend();
+
+// Expande una clave de 16 bytes para el backend indicado
+void aesInitKey(AesKey &ctx, const uint8_t key[16], AesBackend backend = aesDetectBackend());
+
+// CBC en sitio sobre 'blocks' bloques de 16 bytes; iv se actualiza con el último bloque cifrado
+void aesEncryptCBC(const AesKey &ctx, uint8_t iv[16], uint8_t* data, std::size_t blocks);
+
+// CBC inverso en sitio; iv se actualiza con el último bloque de texto cifrado de entrada
+void aesDecryptCBC(const AesKey &ctx, uint8_t iv[16], uint8_t* data, std::size_t blocks);
+
+#endif
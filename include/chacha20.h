@@ -0,0 +1,18 @@
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Tamaño de un bloque de keystream ChaCha20
+constexpr std::size_t CHACHA20_BLOCK_SIZE = 64;
+
+// Aplica XOR con el keystream ChaCha20 sobre 'data' (en sitio).
+// Layout del estado: [constantes][clave:32][contador:64 bits][nonce:64 bits].
+// El keystream empieza en el bloque 'counter', por lo que cualquier trozo que
+// comience en un múltiplo de 64 bytes puede procesarse de forma independiente
+// usando counter = offset / 64.
+void chacha20Xor(const uint8_t key[32], const uint8_t nonce[8], uint64_t counter,
+                 uint8_t* data, std::size_t len);
+
+#endif
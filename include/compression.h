@@ -1,6 +1,10 @@
 #ifndef COMPRESSION_H
 #define COMPRESSION_H
 
+#include "ByteStream.h"
+#include "StreamTransform.h"
+
+#include <memory>
 #include <string>
 
 // Algoritmo Run-Length Encoding (RLE)
@@ -20,4 +24,28 @@ void compressHuffman(const std::string &inputPath, const std::string &outputPath
 
 void decompressHuffman(const std::string &inputPath, const std::string &outputPath);
 
-#endif
\ No newline at end of file
+// Tamaño que tendrá el archivo Huffman 'fd' al descomprimirlo: suma el tamaño original
+// de cada trama recorriendo solo las cabeceras. -1 si no es un archivo regular o válido.
+long long huffmanDecodedSize(int fd);
+
+
+// Transformaciones incrementales para encadenar en memoria (ver StreamTransform.h).
+// Toman sus tablas de la arena del BufferPool actual: el llamador debe mantener
+// abierto un BufferPoolScope mientras las use (las variantes *Stream lo hacen solas).
+std::unique_ptr<StreamTransform> makeRLECompressor();
+std::unique_ptr<StreamTransform> makeRLEDecompressor();
+std::unique_ptr<StreamTransform> makeLZWCompressor();
+std::unique_ptr<StreamTransform> makeLZWDecompressor();
+std::unique_ptr<StreamTransform> makeHuffmanCompressor();
+std::unique_ptr<StreamTransform> makeHuffmanDecompressor();
+
+// Variantes sobre ByteSource/ByteSink (archivos, mmap, memoria o pipes).
+// Retornan false si la entrada es inválida o falla la lectura/escritura.
+bool compressRLEStream(ByteSource &source, ByteSink &sink);
+bool decompressRLEStream(ByteSource &source, ByteSink &sink);
+bool compressLZWStream(ByteSource &source, ByteSink &sink);
+bool decompressLZWStream(ByteSource &source, ByteSink &sink);
+bool compressHuffmanStream(ByteSource &source, ByteSink &sink);
+bool decompressHuffmanStream(ByteSource &source, ByteSink &sink);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Interpreta una lista de CPUs como "0-3,8,10-11". Retorna false si el formato es inválido.
+bool parseCpuList(const std::string &text, std::vector<int> &cpus);
+
+// CPUs en las que el proceso puede correr (sched_getaffinity; respeta taskset y cgroups)
+std::vector<int> availableCpus();
+
+// Nodo NUMA de una CPU según /sys/devices/system/node (0 si no hay información)
+int cpuNode(int cpu);
+
+// Restringe el proceso a 'cpus' y las reparte entre los workers: las CPUs se ordenan
+// alternando nodos NUMA, así el worker i queda en un nodo distinto que el i+1 y los
+// workers se distribuyen parejo entre sockets. Los hilos creados después heredan la
+// restricción. Retorna false si el sistema rechaza la máscara.
+bool setWorkerCpus(const std::vector<int> &cpus);
+
+// Número de CPUs configuradas con setWorkerCpus (0 si no se configuró ninguna)
+size_t workerCpuCount();
+
+// Fija el hilo actual a la CPU del worker 'index' (no hace nada sin setWorkerCpus).
+// Solo lo usan los workers de cómputo de StagedExecutor::runFiles: si otro pool fijara
+// también sus hilos por índice, su worker i y el de cómputo i compartirían CPU.
+// Llamar al iniciar el hilo, antes de reservar su memoria: el kernel ubica cada
+// página en el nodo del hilo que la toca primero, así los buffers y la arena del
+// worker quedan en su nodo local.
+void pinWorkerThread(size_t index);
+
+#endif
@@ -1,6 +1,10 @@
 #ifndef ENCRYPTION_H
 #define ENCRYPTION_H
 
+#include "ByteStream.h"
+#include "StreamTransform.h"
+
+#include <memory>
 #include <string>
 
 // Algoritmo Vigenère
@@ -11,4 +15,27 @@ bool decryptVigenere(const std::string &inputPath, const std::string &outputPath
 bool encryptAES128(const std::string &inputPath, const std::string &outputPath, const std::string &key);
 bool decryptAES128(const std::string &inputPath, const std::string &outputPath, const std::string &key);
 
+// Algoritmo ChaCha20 (cifrado de flujo)
+bool encryptChaCha20(const std::string &inputPath, const std::string &outputPath, const std::string &key);
+bool decryptChaCha20(const std::string &inputPath, const std::string &outputPath, const std::string &key);
+
+// Transformaciones incrementales para encadenar en memoria (ver StreamTransform.h).
+// La clave no debe estar vacía.
+std::unique_ptr<StreamTransform> makeVigenereEncryptor(const std::string &key);
+std::unique_ptr<StreamTransform> makeVigenereDecryptor(const std::string &key);
+std::unique_ptr<StreamTransform> makeAES128Encryptor(const std::string &key);
+std::unique_ptr<StreamTransform> makeAES128Decryptor(const std::string &key);
+std::unique_ptr<StreamTransform> makeChaCha20Encryptor(const std::string &key);
+std::unique_ptr<StreamTransform> makeChaCha20Decryptor(const std::string &key);
+
+// Variantes sobre ByteSource/ByteSink (archivos, mmap, memoria o pipes).
+// Si ambos extremos son archivos regulares, los archivos grandes se procesan
+// en paralelo por trozos.
+bool encryptVigenereStream(ByteSource &source, ByteSink &sink, const std::string &key);
+bool decryptVigenereStream(ByteSource &source, ByteSink &sink, const std::string &key);
+bool encryptAES128Stream(ByteSource &source, ByteSink &sink, const std::string &key);
+bool decryptAES128Stream(ByteSource &source, ByteSink &sink, const std::string &key);
+bool encryptChaCha20Stream(ByteSource &source, ByteSink &sink, const std::string &key);
+bool decryptChaCha20Stream(ByteSource &source, ByteSink &sink, const std::string &key);
+
 #endif
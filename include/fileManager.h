@@ -1,6 +1,8 @@
 #ifndef FILE_MANAGER_H
 #define FILE_MANAGER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -13,9 +15,72 @@ ssize_t readFile(int fd, void* buffer, size_t size);
 // Escribe bytes en un archivo abierto
 ssize_t writeFile(int fd, const void* buffer, size_t size);
 
+// Lee hasta completar 'size' bytes o llegar a EOF. Retorna los bytes leídos o -1 si falla.
+ssize_t readFull(int fd, void* buffer, size_t size);
+
+// Escribe los 'size' bytes completos (reintentando escrituras parciales). Retorna size o -1 si falla.
+ssize_t writeAll(int fd, const void* buffer, size_t size);
+
+// Lee 'size' bytes desde la posición 'offset' (pread, sin mover el cursor). Retorna los bytes leídos o -1.
+ssize_t readFileAt(int fd, void* buffer, size_t size, long long offset);
+
+// Escribe 'size' bytes en la posición 'offset' (pwrite, sin mover el cursor). Retorna size o -1.
+ssize_t writeFileAt(int fd, const void* buffer, size_t size, long long offset);
+
+// Ajusta el tamaño de un archivo abierto (ftruncate). Retorna true si tuvo éxito.
+bool setFileSize(int fd, long long size);
+
+// Reserva en disco 'size' bytes para una salida (fallocate con FALLOC_FL_KEEP_SIZE):
+// el archivo queda en pocos extents contiguos y las escrituras no asignan bloques. El
+// tamaño visible no cambia. Retorna false si el sistema de archivos no lo soporta o la
+// política de E/S (ver IoPolicy, más abajo) lo desactiva.
+bool preallocateFile(int fd, long long size);
+
+// Libera lo reservado con preallocateFile más allá del final actual del archivo
+void trimPreallocation(int fd);
+
 // Cierra el archivo
 void closeFile(int fd);
 
+// Salida que se publica de forma atómica: se escribe en un archivo anónimo (O_TMPFILE)
+// del directorio destino y al terminar se enlaza con su nombre (linkat). Si el sistema
+// de archivos no soporta O_TMPFILE se usa un temporal oculto ".<nombre>.tmp.*" y rename.
+// Así, quien lea el directorio (o lo recorra tras una caída) nunca ve una salida a medias.
+// Si la ruta existe y no es un archivo regular (/dev/null, un FIFO) se abre directamente.
+struct OutputFile {
+    int fd = -1;
+    std::string path;       // ruta final
+    std::string tempPath;   // temporal con nombre (vacío si es anónimo o directo)
+    bool anonymous = false; // O_TMPFILE: sin nombre hasta commitOutputFile
+    bool replace = false;   // la ruta final ya existía
+};
+
+// Crea la salida para 'path'. Retorna false (con perror) si no pudo crearse.
+bool createOutputFile(const std::string &path, OutputFile &out);
+
+// Publica la salida con su nombre final y la cierra. Antes de enlazarla hace fdatasync
+// (salvo IoPolicy::syncOutputs = false), así el nombre nunca apunta a datos que no
+// llegaron a disco. Retorna false si no pudo publicarse (en ese caso no queda nada a
+// medias en la ruta final).
+bool commitOutputFile(OutputFile &out);
+
+// Descarta la salida (el contenido ya escrito se pierde) y la cierra
+void abortOutputFile(OutputFile &out);
+
+// Vista de solo lectura de un archivo completo mapeado en memoria
+struct MappedFile {
+    const uint8_t* data = nullptr;  // nullptr si el archivo está vacío
+    size_t size = 0;
+};
+
+// Mapea el archivo regular 'fd' (que puede cerrarse después) con avisos de lectura
+// secuencial y lectura anticipada. Retorna false si no es un archivo regular (pipe,
+// dispositivo) o si el mapeo falla: el llamador debe leerlo con read().
+bool mapFile(int fd, MappedFile &view);
+
+// Libera una vista creada con mapFile (idempotente)
+void unmapFile(MappedFile &view);
+
 // Verifica si la ruta corresponde a un directorio
 bool isDirectory(const std::string &path);
 
@@ -25,6 +90,9 @@ std::vector<std::string> listFiles(const std::string &directoryPath);
 // Obtiene el tamaño de un archivo (en bytes). Retorna -1 si falla.
 long long getFileSize(const std::string &path);
 
+// Tamaño de un descriptor abierto; -1 si no es un archivo regular (pipe, terminal, etc.)
+long long getFileSize(int fd);
+
 // Formatea el tamaño de archivo en unidades legibles (B, KB, MB, GB, TB)
 std::string formatFileSize(long long bytes);
 
@@ -34,4 +102,45 @@ std::string formatTime(double seconds);
 // Crea directorios recursivamente (como mkdir -p). Retorna true si existe o fue creado.
 bool ensureDirectoryExists(const std::string &path);
 
+// Política de E/S común a todos los módulos: tamaño de los bloques y buffers con que se
+// lee y escribe, y cuánto se pide al kernel por adelantado
+struct IoPolicy {
+    size_t blockSize = 512 * 1024;              // Bloques del lector y el escritor de los lotes
+    size_t streamBufferSize = 256 * 1024;       // Buffers de lectura/escritura de los códecs en streaming
+    size_t prefetchFiles = 4;                   // Archivos de la cola que se piden por adelantado (0 = ninguno)
+    size_t prefetchBytes = 8 * 1024 * 1024;     // Bytes iniciales de cada uno que se piden
+    bool preallocate = true;                    // Reservar las salidas con preallocateFile
+    bool syncOutputs = true;                    // fdatasync de cada salida antes de publicarla
+};
+
+// Los tamaños se redondean a múltiplos de 4 KB (mínimo 4 KB)
+void setIoPolicy(const IoPolicy &policy);
+const IoPolicy& getIoPolicy();
+
+// Avisa al kernel que 'fd' se leerá de principio a fin (POSIX_FADV_SEQUENTIAL: readahead
+// más agresivo). No hace nada en pipes o terminales.
+void adviseSequential(int fd);
+
+// Pide al kernel que empiece a traer a la page cache los primeros 'bytes' del archivo
+// (POSIX_FADV_WILLNEED) sin esperar la lectura. Retorna false si no se pudo abrir.
+bool prefetchFile(const std::string &path, size_t bytes);
+
+// Modo --direct-io: el lote no desplaza de la page cache los datos de otros procesos.
+// Lo leído se descarta al consumirlo (POSIX_FADV_DONTNEED) y lo escrito se manda a
+// disco sobre la marcha (sync_file_range) y se descarta una ventana más atrás. Las
+// funciones de arriba que leen/escriben por posición y closeFile ya lo aplican.
+void setDirectIo(bool enabled);
+bool directIoEnabled();
+
+// Descartan de la page cache un rango ya leído o escrito (llamar solo con --direct-io)
+void releaseReadRange(int fd, long long offset, long long length);
+void releaseWrittenRange(int fd, long long offset, long long length);
+
+// Backend de E/S para los archivos de un lote: io_uring (las lecturas y escrituras de
+// varios archivos quedan en vuelo a la vez y se envían al kernel en lote) o las
+// llamadas read()/write() de arriba. Con Auto se usa io_uring si el kernel lo permite.
+enum class IoBackend { Auto, Uring, Sync };
+void setIoBackend(IoBackend backend);
+IoBackend getIoBackend();
+
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "ByteStream.h"
+#include "BufferPool.h"
+#include "StreamTransform.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Una etapa del pipeline: la misma operación en sus dos formas
+struct PipelineStage {
+    // Lee su origen hasta EOF y escribe el resultado en su destino (ver las variantes *Stream)
+    std::function<bool(ByteSource &source, ByteSink &sink)> run;
+    // Transformación incremental equivalente (ver StreamTransform.h)
+    std::function<std::unique_ptr<StreamTransform>()> transform;
+};
+
+// Encadena las etapas: la primera lee de 'source' y solo la última escribe en 'sink'.
+// Si la entrada es de tamaño conocido y menor a 16 MB, las transformaciones se encadenan
+// en el hilo llamador (runTransformChain), sin pipes ni hilos por archivo. Si no (archivos
+// grandes, stdin), cada etapa intermedia corre en su propio hilo unida a la siguiente por
+// un pipe de capacidad acotada: una etapa rápida se bloquea hasta que la siguiente
+// consume. Retorna false si alguna etapa falla.
+// Si se indica 'memory', cada etapa i toma sus buffers de memory->stage(i) (ver BufferPool.h).
+// El proceso debe ignorar SIGPIPE (ver main): si una etapa falla y cierra su pipe, la
+// anterior recibe EPIPE en write().
+bool runPipeline(ByteSource &source, ByteSink &sink, const std::vector<PipelineStage> &stages,
+                 WorkerMemory* memory = nullptr);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef VIGENERE_H
+#define VIGENERE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Clave expandida una sola vez: desplazamiento (0-25) por posición de la clave,
+// repetida con holgura para que el kernel SIMD pueda leer 16 posiciones seguidas
+struct VigenereTable {
+    std::vector<uint8_t> shifts;
+    std::size_t keyLen;
+};
+
+// Construye la tabla; al desencriptar guarda el desplazamiento complementario (26 - k)
+VigenereTable vigenereBuildTable(const std::string &key, bool decrypt);
+
+// Aplica Vigenère a n bytes (solo letras ASCII avanzan la clave).
+// keyPos es la posición actual dentro de la clave y se actualiza al terminar.
+void vigenereApply(const VigenereTable &table, const uint8_t* in, uint8_t* out,
+                   std::size_t n, std::size_t &keyPos);
+
+// Cuenta las letras ASCII (las únicas que avanzan la clave) en n bytes
+std::size_t vigenereCountLetters(const uint8_t* data, std::size_t n);
+
+#endif
@@ -0,0 +1,183 @@
+#include "BufferPool.h"
+
+#include <sys/mman.h>
+#include <cstdio>
+#include <new>
+#include <utility>
+
+// Tamaño de cada bloque de la arena y de una huge page (x86-64)
+static constexpr size_t ARENA_BLOCK_SIZE = 4 * 1024 * 1024;
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+// Bytes de bloques que una arena conserva tras rewind(); el resto se devuelve al sistema
+static constexpr size_t ARENA_RETAIN = 32 * 1024 * 1024;
+
+// Límites de lo que un pool guarda para reutilizar
+static constexpr size_t POOL_MAX_BUFFERS = 16;
+static constexpr size_t POOL_MAX_BYTES = 64 * 1024 * 1024;
+
+// Reserva un bloque alineado a huge page: se pide de más y se recortan los extremos
+static uint8_t* mapHugeBlock(size_t size) {
+    size_t span = size + HUGE_PAGE_SIZE;
+    void* p = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return nullptr;
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(p);
+    uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(static_cast<uintptr_t>(HUGE_PAGE_SIZE) - 1);
+    size_t head = aligned - start;
+    size_t tail = span - head - size;
+    if (head > 0) munmap(p, head);
+    if (tail > 0) munmap(reinterpret_cast<void*>(aligned + size), tail);
+
+#ifdef MADV_HUGEPAGE
+    madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE); // best-effort: depende de THP
+#endif
+    return reinterpret_cast<uint8_t*>(aligned);
+}
+
+// --- Memoria de buffers ---
+
+static size_t hugeRound(size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+void* allocateBufferMemory(size_t bytes) {
+    if (bytes < HUGE_PAGE_SIZE) return ::operator new(bytes);
+    uint8_t* p = mapHugeBlock(hugeRound(bytes));
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void releaseBufferMemory(void* p, size_t bytes) {
+    if (bytes < HUGE_PAGE_SIZE) {
+        ::operator delete(p);
+        return;
+    }
+    munmap(p, hugeRound(bytes));
+}
+
+// --- Arena ---
+
+Arena::~Arena() {
+    for (auto &b : blocks_) munmap(b.data, b.size);
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    // Buscar espacio en el bloque actual o en los siguientes ya reservados
+    while (current_ < blocks_.size()) {
+        Block &b = blocks_[current_];
+        size_t start = (offset_ + align - 1) & ~(align - 1);
+        if (start + size <= b.size) {
+            offset_ = start + size;
+            return b.data + start;
+        }
+        ++current_;
+        offset_ = 0;
+    }
+
+    // Bloque nuevo (más grande si la petición no cabe en uno normal)
+    size_t blockSize = ARENA_BLOCK_SIZE;
+    if (size + align > blockSize) {
+        blockSize = (size + align + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+    uint8_t* data = mapHugeBlock(blockSize);
+    if (!data) {
+        perror("Error al reservar memoria para la arena");
+        throw std::bad_alloc();
+    }
+    blocks_.push_back({data, blockSize});
+    current_ = blocks_.size() - 1;
+    offset_ = size;
+    return data;
+}
+
+void Arena::rewind(const Marker &marker) {
+    current_ = marker.block;
+    offset_ = marker.offset;
+
+    // Devolver al sistema los bloques sin uso que exceden lo que se conserva
+    size_t kept = 0;
+    size_t keep = blocks_.size();
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        kept += blocks_[i].size;
+        if (kept > ARENA_RETAIN && i > current_) {
+            keep = i;
+            break;
+        }
+    }
+    while (blocks_.size() > keep) {
+        munmap(blocks_.back().data, blocks_.back().size);
+        blocks_.pop_back();
+    }
+}
+
+// --- BufferPool ---
+
+static thread_local BufferPool* boundPool = nullptr;
+
+BufferPool::BufferPool() : cachedBytes_(0) {
+    free_.reserve(POOL_MAX_BUFFERS);
+}
+
+ByteBuffer BufferPool::acquire(size_t capacity) {
+    // El buffer libre más pequeño que alcance, para no gastar los grandes en pedidos chicos
+    size_t best = free_.size();
+    for (size_t i = 0; i < free_.size(); ++i) {
+        if (free_[i].capacity() >= capacity &&
+            (best == free_.size() || free_[i].capacity() < free_[best].capacity())) {
+            best = i;
+        }
+    }
+
+    ByteBuffer buffer;
+    if (best < free_.size()) {
+        buffer = std::move(free_[best]);
+        free_[best] = std::move(free_.back());
+        free_.pop_back();
+        cachedBytes_ -= buffer.capacity();
+        buffer.clear();
+    } else {
+        buffer.reserve(capacity);
+    }
+    return buffer;
+}
+
+void BufferPool::release(ByteBuffer &&buffer) {
+    size_t cap = buffer.capacity();
+    if (cap == 0 || free_.size() >= POOL_MAX_BUFFERS || cachedBytes_ + cap > POOL_MAX_BYTES) {
+        ByteBuffer().swap(buffer);
+        return;
+    }
+    cachedBytes_ += cap;
+    free_.push_back(std::move(buffer));
+}
+
+BufferPool& BufferPool::current() {
+    static thread_local BufferPool threadPool;
+    return boundPool ? *boundPool : threadPool;
+}
+
+// --- BufferPoolScope ---
+
+BufferPoolScope::BufferPoolScope(BufferPool &pool)
+    : pool_(pool), previous_(boundPool), mark_(pool.arena().mark()) {
+    boundPool = &pool_;
+}
+
+BufferPoolScope::~BufferPoolScope() {
+    pool_.arena().rewind(mark_);
+    boundPool = previous_;
+}
+
+// --- WorkerMemory ---
+
+BufferPool& WorkerMemory::stage(size_t index) {
+    while (stages_.size() <= index) {
+        stages_.emplace_back(new BufferPool());
+    }
+    return *stages_[index];
+}
+
+WorkerMemory& WorkerMemory::local() {
+    static thread_local WorkerMemory memory;
+    return memory;
+}
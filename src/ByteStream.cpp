@@ -0,0 +1,185 @@
+#include "ByteStream.h"
+#include "fileManager.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+ssize_t ByteSource::readFull(void* buffer, size_t size) {
+    char* dst = static_cast<char*>(buffer);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = read(dst + total, size - total);
+        if (n == -1) return -1;
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+// --- FdSource / FdSink ---
+
+ssize_t FdSource::read(void* buffer, size_t size) {
+    ssize_t n = readFile(fd_, buffer, size);
+    if (n > 0 && directIoEnabled()) {
+        releaseReadRange(fd_, pos_, n);
+        pos_ += n;
+    }
+    return n;
+}
+
+long long FdSource::size() const {
+    return getFileSize(fd_);
+}
+
+int FdSource::fd() const {
+    // Solo archivos regulares leídos desde el inicio admiten pread por offsets absolutos
+    if (getFileSize(fd_) < 0 || lseek(fd_, 0, SEEK_CUR) != 0) return -1;
+    return fd_;
+}
+
+void FdSource::close() {
+    if (owned_ && fd_ != -1) {
+        closeFile(fd_);
+        fd_ = -1;
+    }
+}
+
+ssize_t FdSink::write(const void* buffer, size_t size) {
+    ssize_t n = writeAll(fd_, buffer, size);
+    if (n > 0 && directIoEnabled()) {
+        releaseWrittenRange(fd_, pos_, n);
+        pos_ += n;
+    }
+    return n;
+}
+
+int FdSink::fd() const {
+    // Solo un archivo regular vacío puede escribirse por offsets absolutos
+    if (getFileSize(fd_) != 0 || lseek(fd_, 0, SEEK_CUR) != 0) return -1;
+    return fd_;
+}
+
+void FdSink::close() {
+    if (owned_ && fd_ != -1) {
+        closeFile(fd_);
+        fd_ = -1;
+    }
+}
+
+// --- MmapSource ---
+
+MmapSource::MmapSource(int fd) : fd_(fd), pos_(0) {
+    valid_ = mapFile(fd, view_);
+}
+
+MmapSource::~MmapSource() {
+    unmapFile(view_);
+}
+
+ssize_t MmapSource::read(void* buffer, size_t size) {
+    if (!view_.data) return 0;
+    size_t n = std::min(size, view_.size - pos_);
+    std::memcpy(buffer, view_.data + pos_, n);
+    pos_ += n;
+    return static_cast<ssize_t>(n);
+}
+
+// --- Memoria ---
+
+ssize_t MemorySource::read(void* buffer, size_t size) {
+    size_t n = std::min(size, size_ - pos_);
+    std::memcpy(buffer, data_ + pos_, n);
+    pos_ += n;
+    return static_cast<ssize_t>(n);
+}
+
+ssize_t MemorySink::write(const void* buffer, size_t size) {
+    const uint8_t* src = static_cast<const uint8_t*>(buffer);
+    out_.insert(out_.end(), src, src + size);
+    return static_cast<ssize_t>(size);
+}
+
+// --- Contadores ---
+
+ssize_t CountingSource::read(void* buffer, size_t size) {
+    ssize_t n = inner_.read(buffer, size);
+    if (n > 0) count_ += n;
+    return n;
+}
+
+ssize_t CountingSink::write(const void* buffer, size_t size) {
+    ssize_t n = inner_.write(buffer, size);
+    if (n > 0) count_ += n;
+    return n;
+}
+
+// --- Pipes ---
+
+bool createPipe(std::unique_ptr<PipeSource> &source, std::unique_ptr<PipeSink> &sink, size_t capacity) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) == -1) {
+        perror("Error al crear pipe");
+        return false;
+    }
+    fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(capacity)); // best-effort: el kernel puede limitarla
+    source.reset(new PipeSource(fds[0]));
+    sink.reset(new PipeSink(fds[1]));
+    return true;
+}
+
+// "-" representa la entrada o salida estándar (no se cierran al terminar)
+static const char* STDIO_PATH = "-";
+
+bool transformFile(const std::string &inputPath, const std::string &outputPath,
+                   const std::function<bool(ByteSource&, ByteSink&)> &transform,
+                   long long outputSizeHint) {
+    bool stdinInput = (inputPath == STDIO_PATH);
+    bool stdoutOutput = (outputPath == STDIO_PATH);
+
+    int inputFd = stdinInput ? STDIN_FILENO : openFile(inputPath, O_RDONLY);
+    if (inputFd == -1) return false;
+    // La salida se publica completa al final: si algo falla no queda a medias en outputPath
+    OutputFile output;
+    if (stdoutOutput) {
+        output.fd = STDOUT_FILENO;
+    } else if (!createOutputFile(outputPath, output)) {
+        if (!stdinInput) closeFile(inputFd);
+        return false;
+    }
+    int outputFd = output.fd;
+
+    bool preallocated = !stdoutOutput && preallocateFile(outputFd, outputSizeHint);
+
+    bool ok;
+    FdSink sink(outputFd);
+    // Con --direct-io no se mapea: las páginas mapeadas no pueden descartarse mientras se usan
+    if (!stdinInput && getFileSize(inputFd) > 0 && !directIoEnabled()) {
+        MmapSource mapped(inputFd);
+        if (mapped.valid()) {
+            ok = transform(mapped, sink);
+        } else {
+            adviseSequential(inputFd);
+            FdSource source(inputFd);
+            ok = transform(source, sink);
+        }
+    } else {
+        // stdin (pipe, terminal o archivo redirigido) se consume en una sola pasada;
+        // con --direct-io también los archivos, para descartar lo leído
+        adviseSequential(inputFd);
+        FdSource source(inputFd);
+        ok = transform(source, sink);
+    }
+    if (!stdinInput) closeFile(inputFd);
+    // La estimación puede quedar por encima del tamaño real (compresión, errores)
+    if (preallocated) trimPreallocation(outputFd);
+    if (stdoutOutput) return ok;
+    if (!ok) {
+        abortOutputFile(output);
+        return false;
+    }
+    return commitOutputFile(output);
+}
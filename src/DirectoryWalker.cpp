@@ -0,0 +1,119 @@
+#include "DirectoryWalker.h"
+#include "ThreadPool.h"
+#include "fileManager.h"
+
+#include <dirent.h>     // fdopendir, readdir
+#include <fcntl.h>      // open, O_DIRECTORY
+#include <sys/stat.h>   // fstatat, mkdir
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// Más hilos que esto no aceleran el recorrido: compiten por los mismos locks del VFS
+static constexpr size_t MAX_WALK_THREADS = 16;
+static constexpr size_t MIN_WALK_THREADS = 4;
+
+namespace {
+
+struct WalkState {
+    TaskGroup &group;
+    const DirectoryWalker::Visitor &visit;
+    std::atomic<size_t> files{0};
+
+    WalkState(TaskGroup &g, const DirectoryWalker::Visitor &v) : group(g), visit(v) {}
+};
+
+} // namespace
+
+// Entrada con los metadatos de 'st' (o desconocidos si no se pudo consultar)
+static WalkEntry makeEntry(std::string inPath, std::string outPath, const struct stat* st) {
+    if (!st) return WalkEntry{std::move(inPath), std::move(outPath), -1, 0, 0};
+    long long mtimeNs = static_cast<long long>(st->st_mtim.tv_sec) * 1000000000LL + st->st_mtim.tv_nsec;
+    return WalkEntry{std::move(inPath), std::move(outPath), static_cast<long long>(st->st_size),
+                     mtimeNs, static_cast<uint64_t>(st->st_ino)};
+}
+
+// Quita las barras finales (salvo en "/")
+static std::string trimTrailingSlash(std::string path) {
+    while (path.size() > 1 && path.back() == '/') path.pop_back();
+    return path;
+}
+
+// Visita una carpeta: crea su carpeta de salida, entrega sus archivos y agrega una
+// tarea por subcarpeta
+static void walkDirectory(WalkState &state, const std::string &inPath, const std::string &outPath) {
+    // El padre ya creó la suya antes de agregar esta tarea, así que basta un mkdir
+    if (mkdir(outPath.c_str(), 0755) != 0 && errno != EEXIST) {
+        perror(("Error al crear directorio: " + outPath).c_str());
+    }
+
+    int dirFd = open(inPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR* dir = (dirFd == -1) ? nullptr : fdopendir(dirFd);
+    if (dir == nullptr) {
+        perror(("Error al abrir directorio: " + inPath).c_str());
+        if (dirFd != -1) close(dirFd);
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        const char* name = entry->d_name;
+        if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) continue;
+
+        std::string subIn = inPath + "/" + name;
+        std::string subOut = outPath + "/" + name;
+        struct stat st;
+        bool haveStat = false;
+        bool isDir = (entry->d_type == DT_DIR);
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+            // Sin d_type (algunos sistemas de archivos) o enlace: resolver el destino
+            haveStat = fstatat(dirFd, name, &st, 0) == 0;
+            isDir = haveStat && S_ISDIR(st.st_mode);
+        }
+
+        if (isDir) {
+            state.group.run([&state, subIn, subOut] { walkDirectory(state, subIn, subOut); });
+            continue;
+        }
+        if (!haveStat) haveStat = fstatat(dirFd, name, &st, AT_SYMLINK_NOFOLLOW) == 0;
+        state.files.fetch_add(1, std::memory_order_relaxed);
+        state.visit(makeEntry(std::move(subIn), std::move(subOut), haveStat ? &st : nullptr));
+    }
+    closedir(dir);
+}
+
+DirectoryWalker::DirectoryWalker(size_t threads) : threads_(threads) {
+    if (threads_ == 0) {
+        threads_ = std::min(MAX_WALK_THREADS, std::max(MIN_WALK_THREADS, ThreadPool::defaultThreadCount()));
+    }
+}
+
+size_t DirectoryWalker::walk(const std::string &inputRoot, const std::string &outputRoot, const Visitor &visit) {
+    std::string inPath = trimTrailingSlash(inputRoot);
+    std::string outPath = trimTrailingSlash(outputRoot);
+
+    struct stat st;
+    bool found = stat(inPath.c_str(), &st) == 0;
+    if (!found || !S_ISDIR(st.st_mode)) {
+        // Un solo archivo: asegurar que exista la carpeta de su salida
+        size_t pos = outPath.find_last_of('/');
+        if (pos == std::string::npos) ensureDirectoryExists(".");
+        else ensureDirectoryExists(pos == 0 ? "/" : outPath.substr(0, pos));
+        // Si no existe (o es "-", stdin) el error se informa al abrirlo
+        visit(makeEntry(inputRoot, outputRoot, found ? &st : nullptr));
+        return 1;
+    }
+
+    // Las carpetas de más arriba pueden no existir todavía
+    ensureDirectoryExists(outPath);
+
+    ThreadPool pool(threads_);
+    TaskGroup group(pool);
+    WalkState state(group, visit);
+    group.run([&state, &inPath, &outPath] { walkDirectory(state, inPath, outPath); });
+    group.wait();
+    return state.files.load();
+}
@@ -0,0 +1,175 @@
+#include "IoRing.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+static int ringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static int ringRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// IORING_OP_READ/WRITE llegaron en el kernel 5.6, igual que IORING_REGISTER_PROBE: en
+// 5.1-5.5 io_uring_setup funciona pero cada lectura terminaría con -EINVAL
+static bool supportsReadWrite(int fd) {
+    const unsigned maxOps = 256;
+    std::vector<uint8_t> buffer(sizeof(io_uring_probe) + maxOps * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+    if (ringRegister(fd, IORING_REGISTER_PROBE, probe, maxOps) != 0) return false;
+    auto supported = [probe](unsigned op) {
+        return op <= probe->last_op && op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    };
+    return supported(IORING_OP_READ) && supported(IORING_OP_WRITE) &&
+           supported(IORING_OP_READ_FIXED) && supported(IORING_OP_WRITE_FIXED);
+}
+
+IoRing::IoRing(unsigned entries)
+    : fd_(-1), entries_(0), toSubmit_(0), inFlight_(0), fixedBuffers_(false),
+      sqRing_(MAP_FAILED), sqRingSize_(0), cqRing_(MAP_FAILED), cqRingSize_(0), sqes_(MAP_FAILED), sqesSize_(0) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = ringSetup(entries, &params);
+    if (fd < 0) return; // sin io_uring: el llamador usa read()/write()
+    if (!supportsReadWrite(fd)) {
+        close(fd);
+        return;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        if (cqRingSize_ > sqRingSize_) sqRingSize_ = cqRingSize_;
+        cqRingSize_ = sqRingSize_;
+    }
+
+    sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing_ != MAP_FAILED) {
+        cqRing_ = singleMap ? sqRing_
+                            : mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    }
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    if (cqRing_ != MAP_FAILED) {
+        sqes_ = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    }
+    if (sqes_ == MAP_FAILED) {
+        if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) munmap(cqRing_, cqRingSize_);
+        if (sqRing_ != MAP_FAILED) munmap(sqRing_, sqRingSize_);
+        sqRing_ = cqRing_ = MAP_FAILED;
+        close(fd);
+        return;
+    }
+
+    char* sq = static_cast<char*>(sqRing_);
+    char* cq = static_cast<char*>(cqRing_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    entries_ = params.sq_entries;
+    fd_ = fd;
+}
+
+IoRing::~IoRing() {
+    if (fd_ < 0) return;
+    // Las operaciones en vuelo apuntan a buffers del llamador: esperar a que terminen
+    while (inFlight_ > 0) {
+        if (!submit(1)) break;
+        uint64_t userData;
+        int result;
+        while (popCompletion(userData, result)) {}
+    }
+    munmap(sqes_, sqesSize_);
+    if (cqRing_ != sqRing_) munmap(cqRing_, cqRingSize_);
+    munmap(sqRing_, sqRingSize_);
+    close(fd_);
+}
+
+bool IoRing::registerBuffers(const std::vector<iovec> &buffers) {
+    if (fd_ < 0 || buffers.empty()) return false;
+    fixedBuffers_ = ringRegister(fd_, IORING_REGISTER_BUFFERS, buffers.data(), static_cast<unsigned>(buffers.size())) == 0;
+    return fixedBuffers_;
+}
+
+bool IoRing::prepareRead(int fd, void* buffer, unsigned len, long long offset, uint64_t userData, int bufferIndex) {
+    int op = (bufferIndex >= 0 && fixedBuffers_) ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    return prepare(op, fd, buffer, len, offset, userData, bufferIndex);
+}
+
+bool IoRing::prepareWrite(int fd, const void* buffer, unsigned len, long long offset, uint64_t userData, int bufferIndex) {
+    int op = (bufferIndex >= 0 && fixedBuffers_) ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    return prepare(op, fd, buffer, len, offset, userData, bufferIndex);
+}
+
+bool IoRing::prepare(int opcode, int fd, const void* buffer, unsigned len, long long offset, uint64_t userData, int bufferIndex) {
+    // Como máximo 'entries_' en vuelo: la cola de resultados (el doble) nunca se desborda
+    if (fd_ < 0 || inFlight_ >= entries_) return false;
+    unsigned tail = *sqTail_;
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if (tail - head >= entries_) return false;
+
+    unsigned index = tail & *sqMask_;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = static_cast<uint8_t>(opcode);
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = len;
+    sqe->off = static_cast<uint64_t>(offset);
+    sqe->user_data = userData;
+    if (opcode == IORING_OP_READ_FIXED || opcode == IORING_OP_WRITE_FIXED) {
+        sqe->buf_index = static_cast<uint16_t>(bufferIndex);
+    }
+    sqArray_[index] = index;
+    __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    ++toSubmit_;
+    ++inFlight_;
+    return true;
+}
+
+bool IoRing::submit(unsigned waitFor) {
+    if (fd_ < 0) return false;
+    if (toSubmit_ == 0 && waitFor == 0) return true;
+    while (true) {
+        int ret = ringEnter(fd_, toSubmit_, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0);
+        if (ret >= 0) {
+            toSubmit_ -= static_cast<unsigned>(ret) < toSubmit_ ? static_cast<unsigned>(ret) : toSubmit_;
+            if (toSubmit_ == 0 || waitFor == 0) return true;
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EBUSY) {
+            // El kernel no acepta más por ahora: recoger resultados y reintentar
+            return true;
+        }
+        return false;
+    }
+}
+
+bool IoRing::popCompletion(uint64_t &userData, int &result) {
+    if (fd_ < 0) return false;
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    if (head == tail) return false;
+    const io_uring_cqe* cqe = static_cast<const io_uring_cqe*>(cqes_) + (head & *cqMask_);
+    userData = cqe->user_data;
+    result = cqe->res;
+    __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+    --inFlight_;
+    return true;
+}
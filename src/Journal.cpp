@@ -6,8 +6,12 @@
 #include <algorithm>
 #include <sys/stat.h>
 
+// Ancho reservado en el encabezado para cada total que se completa al final
+static constexpr size_t TOTAL_FIELD_WIDTH = 24;
+
 // Constructor
-Journal::Journal(const std::string& operation, const std::string& targetName, bool isDirectory) {
+Journal::Journal(const std::string& operation, const std::string& targetName, bool isDirectory)
+    : directory(isDirectory), totalFilesPos(-1), totalSizePos(-1) {
     startTime = std::chrono::steady_clock::now();
     
     // Crear directorio journal si no existe
@@ -94,7 +98,8 @@ void Journal::writeHeader(const std::string& operation, const std::string& targe
     
     logFile << "========================================\n";
     
-    if (totalFiles > 1) {
+    bool folder = directory || totalFiles > 1;
+    if (folder) {
         logFile << "JOURNAL DE OPERACIÓN - CARPETA\n";
     } else {
         logFile << "JOURNAL DE OPERACIÓN - ARCHIVO\n";
@@ -103,14 +108,24 @@ void Journal::writeHeader(const std::string& operation, const std::string& targe
     logFile << "========================================\n";
     logFile << "Tipo: " << operation << "\n";
     
-    if (totalFiles > 1) {
+    if (folder) {
         logFile << "Carpeta: " << targetPath << "\n";
         if (!sourcePath.empty()) {
             logFile << "Ruta: " << sourcePath << "\n";
         }
-        logFile << "Total archivos: " << totalFiles << "\n";
-        if (totalSize > 0) {
-            logFile << "Tamaño total: " << formatFileSize(totalSize) << "\n";
+        if (totalFiles < 0) {
+            // Espacio reservado que finalizeTotals sobrescribe
+            logFile << "Total archivos: ";
+            totalFilesPos = logFile.tellp();
+            logFile << std::string(TOTAL_FIELD_WIDTH, ' ') << "\n";
+            logFile << "Tamaño total: ";
+            totalSizePos = logFile.tellp();
+            logFile << std::string(TOTAL_FIELD_WIDTH, ' ') << "\n";
+        } else {
+            logFile << "Total archivos: " << totalFiles << "\n";
+            if (totalSize > 0) {
+                logFile << "Tamaño total: " << formatFileSize(totalSize) << "\n";
+            }
         }
     } else {
         logFile << "Archivo: " << targetPath << "\n";
@@ -130,6 +145,24 @@ void Journal::writeHeader(const std::string& operation, const std::string& targe
     logFile.flush();
 }
 
+// Completa los totales reservados en el encabezado
+void Journal::finalizeTotals(int totalFiles, long long totalSize) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (totalFilesPos == std::streampos(-1)) return;
+
+    auto overwrite = [&](std::streampos pos, const std::string &value) {
+        std::string field = value.substr(0, TOTAL_FIELD_WIDTH);
+        field.resize(TOTAL_FIELD_WIDTH, ' ');
+        logFile.seekp(pos);
+        logFile << field;
+    };
+    overwrite(totalFilesPos, std::to_string(totalFiles));
+    overwrite(totalSizePos, formatFileSize(totalSize));
+    logFile.seekp(0, std::ios::end);
+    logFile.flush();
+    totalFilesPos = totalSizePos = std::streampos(-1);
+}
+
 // Escribe una entrada de log
 void Journal::log(const std::string& message) {
     std::lock_guard<std::mutex> lock(writeMutex);
@@ -0,0 +1,286 @@
+#include "Manifest.h"
+#include "aes.h"
+
+#include <fcntl.h>      // O_RDONLY
+#include <sys/stat.h>   // stat
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static const char MANIFEST_MAGIC[8] = {'F', 'U', 'M', 'A', 'N', 'I', 'F', '1'};
+
+// Bloques AES encadenados para derivar el valor de la clave que guarda el manifiesto
+static constexpr size_t KEY_CHECK_BLOCKS = 1 << 17;
+
+namespace {
+
+struct Header {
+    char magic[8];
+    uint64_t config;
+    uint64_t count;
+    uint64_t salt;
+};
+
+} // namespace
+
+static_assert(sizeof(Header) == 32, "encabezado del manifiesto de 32 bytes");
+static_assert(sizeof(Manifest::Entry) == 64, "entradas del manifiesto de 64 bytes");
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+uint64_t fastHash64(const void* data, size_t size) {
+    const uint64_t K1 = 0x9E3779B97F4A7C15ULL;
+    const uint64_t K2 = 0xC2B2AE3D27D4EB4FULL;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h = size * K1;
+
+    // De a 8 bytes, luego el resto
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        h = rotl64(h ^ rotl64(w * K2, 31) * K1, 27) * K1 + K2;
+    }
+    uint64_t tail = 0;
+    for (size_t j = 0; i + j < size; ++j) tail |= static_cast<uint64_t>(p[i + j]) << (8 * j);
+    h ^= rotl64(tail * K2, 31) * K1;
+
+    // Mezcla final (fmix64 de MurmurHash3)
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Hash del contenido de un archivo (0 si no pudo leerse)
+static uint64_t hashFileContent(const std::string &path) {
+    int fd = openFile(path, O_RDONLY);
+    if (fd == -1) return 0;
+    MappedFile view;
+    bool mapped = mapFile(fd, view);
+    closeFile(fd);
+    if (!mapped) return 0;
+    uint64_t h = fastHash64(view.data, view.size);
+    unmapFile(view);
+    return h == 0 ? 1 : h;  // 0 queda para "sin hash"
+}
+
+// Tamaño de una salida; -1 si no existe (sin perror: es un caso esperado)
+static long long outputFileSize(const std::string &path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return -1;
+    return static_cast<long long>(st.st_size);
+}
+
+// Sal aleatoria para el hash de la clave (/dev/urandom, o el reloj si no está)
+static uint64_t randomSalt() {
+    uint64_t salt = 0;
+    int fd = openFile("/dev/urandom", O_RDONLY);
+    if (fd != -1) {
+        if (readFull(fd, &salt, sizeof(salt)) != static_cast<ssize_t>(sizeof(salt))) salt = 0;
+        closeFile(fd);
+    }
+    if (salt == 0) salt = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return salt;
+}
+
+// Valor de comprobación de la clave: AES-128 con una clave derivada de sal + clave cifra
+// en CBC KEY_CHECK_BLOCKS bloques, cada uno dependiente del anterior. Cuesta unos ms con
+// AES-NI, pero hace lento probar claves por fuerza bruta a partir del manifiesto
+static uint64_t keyCheck(const std::string &key, uint64_t salt) {
+    std::string salted(reinterpret_cast<const char*>(&salt), sizeof(salt));
+    salted += key;
+    uint64_t derived[2];
+    derived[0] = fastHash64(salted.data(), salted.size());
+    salted += '\x01';
+    derived[1] = fastHash64(salted.data(), salted.size());
+    uint8_t keyBytes[16];
+    std::memcpy(keyBytes, derived, sizeof(keyBytes));
+    AesKey aes;
+    aesInitKey(aes, keyBytes);
+
+    uint8_t iv[16];
+    std::memcpy(iv, &salt, sizeof(salt));
+    std::memcpy(iv + sizeof(salt), &salt, sizeof(salt));
+    uint8_t blocks[16 * 256];
+    for (size_t done = 0; done < KEY_CHECK_BLOCKS; done += 256) {
+        std::memset(blocks, 0, sizeof(blocks));
+        aesEncryptCBC(aes, iv, blocks, 256);
+    }
+    return fastHash64(iv, sizeof(iv));
+}
+
+// Hash de la configuración; con clave se le suma su valor de comprobación
+static uint64_t configHash(const std::string &config, const std::string &key, uint64_t salt) {
+    std::string text = config;
+    if (!key.empty()) {
+        uint64_t check = keyCheck(key, salt);
+        text += '|';
+        text.append(reinterpret_cast<const char*>(&check), sizeof(check));
+    }
+    return fastHash64(text.data(), text.size());
+}
+
+static bool entryLess(const Manifest::Entry &a, uint64_t hash) {
+    return a.pathHash < hash;
+}
+
+std::string Manifest::pathFor(const std::string &outputRoot) {
+    std::string root = outputRoot;
+    while (root.size() > 1 && root.back() == '/') root.pop_back();
+    return root + ".manifest";
+}
+
+Manifest::Manifest(const std::string &inputRoot, const std::string &outputRoot,
+                   const std::string &config, const std::string &key, bool useHash)
+    : inputRoot_(inputRoot), path_(pathFor(outputRoot)), salt_(randomSalt()), useHash_(useHash) {
+    while (inputRoot_.size() > 1 && inputRoot_.back() == '/') inputRoot_.pop_back();
+    config_ = configHash(config, key, salt_);
+
+    struct stat st;
+    if (stat(path_.c_str(), &st) != 0) return;  // primera corrida
+    int fd = openFile(path_, O_RDONLY);
+    if (fd == -1) return;
+    bool mapped = mapFile(fd, view_);
+    closeFile(fd);
+    if (!mapped) return;
+
+    // Un manifiesto dañado o de otra configuración (u otra clave) se ignora (se procesa
+    // todo) y el nuevo se guarda con una sal nueva
+    Header header;
+    if (view_.size < sizeof(Header)) { unmapFile(view_); return; }
+    std::memcpy(&header, view_.data, sizeof(Header));
+    size_t entriesEnd = sizeof(Header) + header.count * sizeof(Entry);
+    uint64_t previous = configHash(config, key, header.salt);
+    if (std::memcmp(header.magic, MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC)) != 0 ||
+        header.config != previous || header.count > view_.size / sizeof(Entry) ||
+        entriesEnd > view_.size) {
+        unmapFile(view_);
+        return;
+    }
+    salt_ = header.salt;
+    config_ = previous;
+    entries_ = reinterpret_cast<const Entry*>(view_.data + sizeof(Header));
+    count_ = static_cast<size_t>(header.count);
+    strings_ = reinterpret_cast<const char*>(view_.data + entriesEnd);
+    stringsSize_ = view_.size - entriesEnd;
+}
+
+Manifest::~Manifest() {
+    unmapFile(view_);
+}
+
+std::string Manifest::relativePath(const std::string &inputPath) const {
+    if (inputPath.size() > inputRoot_.size() && inputPath.compare(0, inputRoot_.size(), inputRoot_) == 0 &&
+        inputPath[inputRoot_.size()] == '/') {
+        return inputPath.substr(inputRoot_.size() + 1);
+    }
+    return inputPath;
+}
+
+const Manifest::Entry* Manifest::find(const std::string &relPath, uint64_t hash) const {
+    const Entry* end = entries_ + count_;
+    for (const Entry* e = std::lower_bound(entries_, end, hash, entryLess); e != end && e->pathHash == hash; ++e) {
+        if (e->pathOffset > stringsSize_ || e->pathLength > stringsSize_ - e->pathOffset) return nullptr;
+        if (e->pathLength == relPath.size() &&
+            std::memcmp(strings_ + e->pathOffset, relPath.data(), relPath.size()) == 0) {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+bool Manifest::unchanged(const WalkEntry &entry) {
+    Record record;
+    record.path = relativePath(entry.inputPath);
+    record.meta = Entry();
+    record.meta.pathHash = fastHash64(record.path.data(), record.path.size());
+    record.meta.size = static_cast<uint64_t>(entry.size);
+    record.meta.mtimeNs = entry.mtimeNs;
+    record.meta.inode = entry.inode;
+
+    const Entry* old = (entry.size >= 0 && entries_) ? find(record.path, record.meta.pathHash) : nullptr;
+    bool same = old && old->size == record.meta.size && old->inode == entry.inode;
+    if (same && old->mtimeNs != entry.mtimeNs) {
+        // Otro mtime: con --incremental-hash se compara el contenido
+        same = useHash_ && old->contentHash != 0 && hashFileContent(entry.inputPath) == old->contentHash;
+    }
+    if (same) {
+        // La salida tiene que seguir ahí, completa
+        same = outputFileSize(entry.outputPath) == static_cast<long long>(old->outputSize);
+    }
+
+    if (same) {
+        // Registrados sin hash (corridas sin --incremental-hash): se calcula ahora
+        record.meta.contentHash = (useHash_ && old->contentHash == 0) ? hashFileContent(entry.inputPath)
+                                                                      : old->contentHash;
+        record.meta.outputSize = old->outputSize;
+        std::lock_guard<std::mutex> lock(mutex_);
+        records_.push_back(std::move(record));
+        ++skipped_;
+        return true;
+    }
+
+    if (entry.size < 0) return false;  // sin metadatos no puede registrarse
+    if (useHash_) record.meta.contentHash = hashFileContent(entry.inputPath);
+    record.outputPath = entry.outputPath;
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_[entry.inputPath] = std::move(record);
+    return false;
+}
+
+void Manifest::finish(const std::string &inputPath, bool ok) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(inputPath);
+    if (it == pending_.end()) return;
+    long long outputSize = ok ? outputFileSize(it->second.outputPath) : -1;
+    if (outputSize >= 0) {
+        Record &record = it->second;
+        record.meta.outputSize = static_cast<uint64_t>(outputSize);
+        record.outputPath.clear();
+        records_.push_back(std::move(record));
+    }
+    pending_.erase(it);
+}
+
+bool Manifest::save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::sort(records_.begin(), records_.end(), [](const Record &a, const Record &b) {
+        if (a.meta.pathHash != b.meta.pathHash) return a.meta.pathHash < b.meta.pathHash;
+        return a.path < b.path;
+    });
+
+    std::vector<Entry> entries;
+    entries.reserve(records_.size());
+    std::string strings;
+    for (Record &record : records_) {
+        record.meta.pathOffset = strings.size();
+        record.meta.pathLength = record.path.size();
+        strings += record.path;
+        entries.push_back(record.meta);
+    }
+
+    Header header;
+    std::memcpy(header.magic, MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC));
+    header.config = config_;
+    header.count = entries.size();
+    header.salt = salt_;
+
+    OutputFile out;
+    if (!createOutputFile(path_, out)) return false;
+    if (writeAll(out.fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header)) ||
+        (!entries.empty() && writeAll(out.fd, entries.data(), entries.size() * sizeof(Entry)) !=
+                                 static_cast<ssize_t>(entries.size() * sizeof(Entry))) ||
+        (!strings.empty() && writeAll(out.fd, strings.data(), strings.size()) !=
+                                 static_cast<ssize_t>(strings.size()))) {
+        perror(("Error al escribir el manifiesto: " + path_).c_str());
+        abortOutputFile(out);
+        return false;
+    }
+    return commitOutputFile(out);
+}
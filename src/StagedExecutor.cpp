@@ -0,0 +1,869 @@
+#include "StagedExecutor.h"
+#include "BoundedQueue.h"
+#include "fileManager.h"
+#include "ThreadPool.h"
+#include "cpuAffinity.h"
+#include "IoRing.h"
+
+#include <fcntl.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Los archivos completos se leen y escriben en bloques de getIoPolicy().blockSize
+// Bloques en vuelo por archivo en cada sentido (lector -> cómputo y cómputo -> escritor)
+static constexpr size_t FILE_QUEUE_DEPTH = 4;
+// Archivos abiertos por el lector además de los que están en cómputo (lectura anticipada)
+static constexpr size_t FILE_LOOKAHEAD = 2;
+// Tope de operaciones en vuelo en cada cola io_uring (lector y escritor)
+static constexpr size_t IO_RING_MAX_ENTRIES = 4096;
+
+// Ajuste automático: cada cuánto se mide, con cuántos datos como mínimo para decidir,
+// variación de throughput que se considera ruido y utilización por debajo de la cual
+// los workers están esperando E/S (agregar hilos no ayudaría)
+static constexpr std::chrono::milliseconds TUNE_INTERVAL(250);
+static constexpr uint64_t TUNE_MIN_BYTES = 4 * 1024 * 1024;
+static constexpr double TUNE_TOLERANCE = 0.05;
+static constexpr double TUNE_IO_BOUND = 0.5;
+
+static uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+StagedExecutor::StagedExecutor(size_t computeThreads)
+    : computeThreads_(computeThreads), adaptive_(false), chosenThreads_(0) {
+    if (computeThreads_ == 0) {
+        computeThreads_ = ThreadPool::defaultThreadCount();
+    }
+}
+
+// --- Archivos completos ---
+
+namespace {
+
+struct FileSlot;
+
+// Bloque que viaja entre etapas. Un bloque con last = true no lleva datos:
+// marca el fin del archivo (y si la etapa que lo produjo falló)
+struct FileBlock {
+    ByteBuffer data;
+    bool last = false;
+    bool failed = false;
+    // Para io_uring: slot dueño, buffer registrado, posición en el archivo y bytes ya escritos
+    FileSlot* slot = nullptr;
+    int bufferIndex = -1;
+    long long offset = 0;
+    size_t done = 0;
+};
+
+// Archivo en curso. Cada slot tiene sus propios bloques y colas, así que un archivo
+// lento no puede acaparar la memoria de los demás; los slots se reutilizan.
+struct FileSlot {
+    static constexpr size_t BLOCKS = FILE_QUEUE_DEPTH + 1;
+
+    explicit FileSlot(size_t blockSize)
+        : blockSize(blockSize), inFree(BLOCKS), inFull(BLOCKS), outFree(BLOCKS), outFull(BLOCKS), writeFailed(false) {
+        for (size_t i = 0; i < BLOCKS; ++i) {
+            inBlocks[i].slot = this;
+            outBlocks[i].slot = this;
+            inFree.tryPush(&inBlocks[i]);
+            outFree.tryPush(&outBlocks[i]);
+        }
+    }
+
+    const size_t blockSize;
+    StagedExecutor::FileTask* task = nullptr;  // del lector al escritor, que lo libera
+    int inputFd = -1;                 // solo lo usa el lector
+    long long inputSize = -1;         // tamaño al abrir la entrada (-1 si no es un archivo regular)
+    bool inputAsync = false;          // lector: la entrada se lee con io_uring
+    long long readOffset = 0;         // lector: posición de la próxima lectura
+    FileBlock* reading = nullptr;     // lector: bloque con una lectura en vuelo
+    OutputFile output;                // solo lo usa el escritor (se publica al terminar)
+    bool outputOpened = false;        // solo lo usa el escritor
+    bool outputPreallocated = false;  // escritor: hay espacio reservado que liberar al cerrar
+    bool outputAsync = false;         // escritor: la salida se escribe con io_uring
+    long long writeOffset = 0;        // escritor: posición del próximo bloque
+    size_t writesInFlight = 0;        // escritor: escrituras enviadas sin resultado
+    FileBlock* endMarker = nullptr;   // escritor: marca de fin que espera a esas escrituras
+    FileBlock inBlocks[BLOCKS];
+    FileBlock outBlocks[BLOCKS];
+    BoundedQueue<FileBlock*> inFree;  // cómputo -> lector
+    BoundedQueue<FileBlock*> inFull;  // lector -> cómputo
+    BoundedQueue<FileBlock*> outFree; // escritor -> cómputo
+    BoundedQueue<FileBlock*> outFull; // cómputo -> escritor
+    Parker computeParker;             // el hilo de cómputo espera bloques de este slot
+    std::atomic<bool> writeFailed;    // el escritor avisa al cómputo para que no siga produciendo
+};
+
+// Medidas de un hilo de cómputo para el ajuste automático, cada una en su línea de caché
+struct alignas(CACHE_LINE_SIZE) WorkerStats {
+    std::atomic<uint64_t> bytes{0};   // Bytes de entrada consumidos
+    std::atomic<uint64_t> busyNs{0};  // Tiempo de cómputo (sin esperas), sumado en cada bloque
+    uint64_t markNs = 0;              // Desde cuándo cuenta el cómputo en curso (solo su worker)
+};
+
+// Suma a busyNs el cómputo desde la última marca
+static void markBusy(WorkerStats &stats) {
+    uint64_t now = nowNs();
+    stats.busyNs.fetch_add(now - stats.markNs, std::memory_order_relaxed);
+    stats.markNs = now;
+}
+
+// Espera en 'parker' hasta que ready() sea true. Se llama en cada bloque: el cómputo
+// hasta acá cuenta como ocupado y la espera no, así el ajuste ve la utilización
+// también durante archivos largos
+template <typename Predicate>
+static void waitCounted(Parker &parker, WorkerStats &stats, Predicate ready) {
+    markBusy(stats);
+    if (ready()) return;
+    parker.wait(ready);
+    stats.markNs = nowNs();
+}
+
+// Entrada de un archivo para el hilo de cómputo: entrega los bloques que trae el lector
+class SlotSource : public ByteSource {
+public:
+    SlotSource(FileSlot &slot, Parker &readerParker, WorkerStats &stats)
+        : slot_(slot), readerParker_(readerParker), stats_(stats), current_(nullptr), pos_(0), failed_(false),
+          viewChecked_(false), view_(nullptr) {}
+
+    long long size() const override { return slot_.inputSize; }
+
+    // Un archivo que cabe en un bloque se entrega como vista del bloque del lector,
+    // así los códecs lo procesan sin copiarlo. Solo antes del primer read().
+    const uint8_t* data() const override {
+        if (viewChecked_) return view_;
+        viewChecked_ = true;
+        if (slot_.inputSize <= 0 || slot_.inputSize > static_cast<long long>(slot_.blockSize)) return nullptr;
+        FileBlock* block = nullptr;
+        waitCounted(slot_.computeParker, stats_, [&] { return slot_.inFull.tryPop(block); });
+        current_ = block;
+        pos_ = 0;
+        if (block->last) {
+            failed_ = block->failed;
+        } else if (block->data.size() == static_cast<size_t>(slot_.inputSize)) {
+            view_ = block->data.data();
+            stats_.bytes.fetch_add(block->data.size(), std::memory_order_relaxed);
+        }
+        return view_;
+    }
+
+    size_t dataSize() const override { return data() ? static_cast<size_t>(slot_.inputSize) : 0; }
+
+    ssize_t read(void* buffer, size_t size) override {
+        viewChecked_ = true;
+        if (view_) return 0; // la vista ya entregó todo el contenido
+        while (!current_ || pos_ == current_->data.size()) {
+            if (current_ && current_->last) return current_->failed ? -1 : 0;
+            if (current_) release();
+            FileBlock* block = nullptr;
+            waitCounted(slot_.computeParker, stats_, [&] { return slot_.inFull.tryPop(block); });
+            current_ = block;
+            pos_ = 0;
+            if (current_->last && current_->failed) failed_ = true;
+        }
+        size_t n = std::min(size, current_->data.size() - pos_);
+        std::copy(current_->data.data() + pos_, current_->data.data() + pos_ + n, static_cast<uint8_t*>(buffer));
+        pos_ += n;
+        stats_.bytes.fetch_add(n, std::memory_order_relaxed);
+        return static_cast<ssize_t>(n);
+    }
+
+    // Descarta lo que quede hasta la marca de fin y devuelve todos los bloques al lector
+    void drain() {
+        while (!current_ || !current_->last) {
+            if (current_) release();
+            FileBlock* block = nullptr;
+            slot_.computeParker.wait([&] { return slot_.inFull.tryPop(block); });
+            current_ = block;
+            if (current_->last && current_->failed) failed_ = true;
+        }
+        release();
+    }
+
+    // La lectura del archivo falló (o no se pudo abrir)
+    bool failed() const { return failed_; }
+
+private:
+    FileSlot &slot_;
+    Parker &readerParker_;
+    WorkerStats &stats_;
+    // data() es const pero puede tomar el primer bloque
+    mutable FileBlock* current_;
+    mutable size_t pos_;
+    mutable bool failed_;
+    mutable bool viewChecked_;
+    mutable const uint8_t* view_;
+
+    void release() {
+        slot_.inFree.tryPush(current_);
+        current_ = nullptr;
+        readerParker_.notify();
+    }
+};
+
+// Salida de un archivo para el hilo de cómputo: junta los datos en bloques para el escritor
+class SlotSink : public ByteSink {
+public:
+    SlotSink(FileSlot &slot, Parker &writerParker, WorkerStats &stats)
+        : slot_(slot), writerParker_(writerParker), stats_(stats), current_(nullptr) {}
+
+    ssize_t write(const void* buffer, size_t size) override {
+        if (slot_.writeFailed.load(std::memory_order_relaxed)) return -1;
+        const uint8_t* src = static_cast<const uint8_t*>(buffer);
+        size_t left = size;
+        while (left > 0) {
+            if (!current_) acquire();
+            size_t n = std::min(left, slot_.blockSize - current_->data.size());
+            current_->data.insert(current_->data.end(), src, src + n);
+            src += n;
+            left -= n;
+            if (current_->data.size() == slot_.blockSize) push();
+        }
+        return static_cast<ssize_t>(size);
+    }
+
+    // Envía el último bloque parcial y la marca de fin con el resultado del trabajo
+    void finish(bool ok) {
+        if (current_ && !current_->data.empty()) push();
+        if (!current_) acquire();
+        current_->last = true;
+        current_->failed = !ok;
+        push();
+    }
+
+private:
+    FileSlot &slot_;
+    Parker &writerParker_;
+    WorkerStats &stats_;
+    FileBlock* current_;
+
+    void acquire() {
+        FileBlock* block = nullptr;
+        waitCounted(slot_.computeParker, stats_, [&] { return slot_.outFree.tryPop(block); });
+        current_ = block;
+        current_->data.clear();
+        current_->data.reserve(slot_.blockSize);
+        current_->last = false;
+        current_->failed = false;
+    }
+
+    void push() {
+        slot_.outFull.tryPush(current_);
+        current_ = nullptr;
+        writerParker_.notify();
+    }
+};
+
+} // namespace
+
+// Orden del montículo: arriba el más grande y, entre iguales, el que llegó primero
+bool StagedExecutor::FileQueue::pendingLess(const Pending &a, const Pending &b) {
+    if (a.size != b.size) return a.size < b.size;
+    return a.order > b.order;
+}
+
+StagedExecutor::FileQueue::FileQueue(size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)), count_(0), pushed_(0), closed_(false), consumer_(nullptr) {
+    heap_.reserve(capacity_);
+}
+
+StagedExecutor::FileQueue::~FileQueue() {
+    for (Pending &p : heap_) delete p.task;
+}
+
+void StagedExecutor::FileQueue::push(FileTask task) {
+    FileTask* item = new FileTask(std::move(task));
+    spaceParker_.wait([&] {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (heap_.size() >= capacity_) return false;
+        heap_.push_back({item->inputSize, pushed_.fetch_add(1), item});
+        std::push_heap(heap_.begin(), heap_.end(), pendingLess);
+        count_.store(heap_.size());
+        return true;
+    });
+    taskParker_.notify();
+    if (Parker* consumer = consumer_.load()) consumer->notify();
+}
+
+void StagedExecutor::FileQueue::close() {
+    closed_.store(true);
+    taskParker_.notify();
+    if (Parker* consumer = consumer_.load()) consumer->notify();
+}
+
+bool StagedExecutor::FileQueue::waitForTask() {
+    taskParker_.wait([&] { return !empty() || closed_.load(); });
+    return !empty();
+}
+
+bool StagedExecutor::FileQueue::tryPop(FileTask* &task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (heap_.empty()) return false;
+        std::pop_heap(heap_.begin(), heap_.end(), pendingLess);
+        task = heap_.back().task;
+        heap_.pop_back();
+        count_.store(heap_.size());
+    }
+    spaceParker_.notify();
+    return true;
+}
+
+bool StagedExecutor::FileQueue::drained() const {
+    // closed_ primero: si ya se cerró, todas las tareas están en la cola
+    return closed_.load() && empty();
+}
+
+void StagedExecutor::runFiles(FileQueue &queue, const FileJob &job, const FileDone &done) {
+    // Si el productor ya terminó (un solo archivo, stdin) se conoce cuántos hay
+    const size_t known = queue.closed_.load() ? queue.pushed_.load() : SIZE_MAX;
+    const size_t workers = std::max<size_t>(1, std::min(computeThreads_, known));
+    const size_t slotCount = std::min(workers + FILE_LOOKAHEAD, known);
+    std::vector<std::unique_ptr<FileSlot>> slots;
+    BoundedQueue<FileSlot*> freeSlots(std::max<size_t>(slotCount, 1));
+    BoundedQueue<FileSlot*> readySlots(std::max<size_t>(slotCount, 1));
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots.emplace_back(new FileSlot(getIoPolicy().blockSize));
+        freeSlots.tryPush(slots.back().get());
+    }
+
+    Parker readerParker, writerParker, workParker;
+    queue.consumer_.store(&readerParker);
+
+    // El lector reparte las tareas de la cola: los archivos directos van a directQueue
+    // (los toman los hilos de cómputo) y el resto a un slot. readerDone indica que ya
+    // repartió todas; 'dispatched' cuenta las que pasaron a un slot.
+    std::mutex directMutex;
+    std::deque<FileTask*> directQueue;
+    std::atomic<size_t> directPending(0);
+    const size_t maxDirectPending = 2 * workers;
+    std::atomic<bool> readerDone(false);
+    std::atomic<size_t> dispatched(0);
+    std::atomic<size_t> claimed(0);
+
+    // Con io_uring el lector y el escritor tienen cada uno su cola: las lecturas de todos
+    // los archivos activos (y las escrituras de todos los bloques listos) se envían juntas
+    // en una llamada y quedan en vuelo a la vez. Los buffers de los bloques se reservan
+    // antes de arrancar los hilos para poder registrarlos (sus direcciones no cambian).
+    std::unique_ptr<IoRing> readRing, writeRing;
+    if (slotCount > 0 && getIoBackend() != IoBackend::Sync) {
+        unsigned entries = static_cast<unsigned>(std::min(slotCount * FileSlot::BLOCKS, IO_RING_MAX_ENTRIES));
+        readRing.reset(new IoRing(entries));
+        writeRing.reset(new IoRing(entries));
+        if (readRing->available() && writeRing->available()) {
+            std::vector<iovec> inBuffers, outBuffers;
+            for (auto &slot : slots) {
+                for (size_t i = 0; i < FileSlot::BLOCKS; ++i) {
+                    FileBlock &in = slot->inBlocks[i];
+                    FileBlock &out = slot->outBlocks[i];
+                    in.data.reserve(slot->blockSize);
+                    out.data.reserve(slot->blockSize);
+                    in.bufferIndex = static_cast<int>(inBuffers.size());
+                    out.bufferIndex = static_cast<int>(outBuffers.size());
+                    inBuffers.push_back({in.data.data(), slot->blockSize});
+                    outBuffers.push_back({out.data.data(), slot->blockSize});
+                }
+            }
+            // Si el registro falla (límite de memoria bloqueada) se usan buffers normales
+            readRing->registerBuffers(inBuffers);
+            writeRing->registerBuffers(outBuffers);
+        } else {
+            if (getIoBackend() == IoBackend::Uring) {
+                fprintf(stderr, "io_uring no disponible; se usa read()/write()\n");
+            }
+            readRing.reset();
+            writeRing.reset();
+        }
+    }
+
+    // Lector: toma tareas de la cola a medida que llegan, abre archivos mientras haya
+    // slots libres y reparte lecturas de un bloque por archivo activo, para que ninguno
+    // se quede sin datos
+    auto readerLoop = [&]() {
+        std::vector<FileSlot*> active;
+
+        // Pasa al cómputo un bloque leído (n bytes, 0 en EOF, -1 si falló); en el último cierra el archivo
+        auto deliver = [&](FileSlot &s, FileBlock* block, ssize_t n) {
+            block->last = (n <= 0);
+            block->failed = (n < 0);
+            block->data.resize(n > 0 ? static_cast<size_t>(n) : 0);
+            s.inFull.tryPush(block);
+            s.computeParker.notify();
+            if (block->last) {
+                if (s.inputFd != -1) closeFile(s.inputFd);
+                s.inputFd = -1;
+                active.erase(std::find(active.begin(), active.end(), &s));
+            }
+        };
+
+        // Los próximos archivos de la cola se piden al kernel mientras se leen los actuales
+        const IoPolicy &policy = getIoPolicy();
+        const size_t window = std::max<size_t>(1, policy.prefetchFiles);
+        std::deque<FileTask*> upcoming;
+
+        auto takeTasks = [&]() {
+            bool taken = false;
+            FileTask* task = nullptr;
+            while (upcoming.size() < window && directPending.load() < maxDirectPending && queue.tryPop(task)) {
+                taken = true;
+                if (task->direct) {
+                    {
+                        std::lock_guard<std::mutex> lock(directMutex);
+                        directQueue.push_back(task);
+                    }
+                    directPending.fetch_add(1);
+                    workParker.notify();
+                    continue;
+                }
+                if (policy.prefetchFiles > 0) prefetchFile(task->inputPath, policy.prefetchBytes);
+                upcoming.push_back(task);
+            }
+            return taken;
+        };
+
+        while (true) {
+            bool progress = takeTasks();
+            FileSlot* slot = nullptr;
+            while (!upcoming.empty() && freeSlots.tryPop(slot)) {
+                slot->task = upcoming.front();
+                upcoming.pop_front();
+                slot->inputFd = openFile(slot->task->inputPath, O_RDONLY);
+                if (slot->inputFd != -1) adviseSequential(slot->inputFd);
+                // Solo los archivos regulares se leen por posición; pipes y dispositivos con read()
+                slot->inputSize = slot->inputFd != -1 ? getFileSize(slot->inputFd) : -1;
+                slot->inputAsync = readRing && slot->inputSize >= 0;
+                slot->readOffset = 0;
+                active.push_back(slot);
+                dispatched.fetch_add(1);
+                readySlots.tryPush(slot);
+                workParker.notify();
+                progress = true;
+            }
+
+            for (size_t k = 0; k < active.size(); ) {
+                FileSlot &s = *active[k];
+                FileBlock* block = nullptr;
+                if (s.reading || !s.inFree.tryPop(block)) {
+                    ++k;
+                    continue;
+                }
+                progress = true;
+                if (s.inputAsync) {
+                    block->data.resize(s.blockSize);
+                    if (readRing->prepareRead(s.inputFd, block->data.data(), static_cast<unsigned>(s.blockSize), s.readOffset,
+                                              reinterpret_cast<uint64_t>(block), block->bufferIndex)) {
+                        s.reading = block;
+                    } else {
+                        s.inFree.tryPush(block); // cola llena: se reintenta en la próxima vuelta
+                    }
+                    ++k;
+                    continue;
+                }
+                ssize_t n = -1;
+                if (s.inputFd != -1) {
+                    block->data.resize(s.blockSize);
+                    n = readFull(s.inputFd, block->data.data(), s.blockSize);
+                }
+                deliver(s, block, n);
+                if (!block->last) ++k;
+            }
+
+            if (readRing) {
+                readRing->submit();
+                uint64_t userData;
+                int result;
+                while (readRing->popCompletion(userData, result)) {
+                    FileBlock* block = reinterpret_cast<FileBlock*>(userData);
+                    FileSlot &s = *block->slot;
+                    s.reading = nullptr;
+                    if (result < 0) {
+                        errno = -result;
+                        perror("Error al leer archivo");
+                    } else {
+                        s.readOffset += result;
+                    }
+                    deliver(s, block, result);
+                    progress = true;
+                }
+            }
+
+            if (!progress) {
+                // Cola cerrada y vacía, y todo lo leído ya entregado: no hay más que hacer
+                if (queue.drained() && upcoming.empty() && active.empty()) break;
+                if (readRing && readRing->inFlight() > 0) {
+                    readRing->submit(1); // esperar a que termine alguna lectura
+                    continue;
+                }
+                readerParker.wait([&] {
+                    if (!upcoming.empty() && !freeSlots.empty()) return true;
+                    if (upcoming.size() < window && directPending.load() < maxDirectPending &&
+                        (!queue.empty() || queue.drained())) return true;
+                    for (FileSlot* a : active) {
+                        if (!a->inFree.empty()) return true;
+                    }
+                    return false;
+                });
+            }
+        }
+
+        readerDone.store(true);
+        workParker.notify();
+        writerParker.notify();
+    };
+
+    // Escritor: vacía los bloques de salida de todos los slots; al ver la marca de fin
+    // (y terminar las escrituras en vuelo de ese archivo) lo publica y libera el slot
+    auto writerLoop = [&]() {
+        size_t finished = 0;
+        // readerDone primero: si ya terminó, 'dispatched' no cambia más
+        auto allWritten = [&] { return readerDone.load() && finished == dispatched.load(); };
+
+        auto recycle = [&](FileSlot &s, FileBlock* block) {
+            s.outFree.tryPush(block);
+            s.computeParker.notify();
+        };
+
+        while (!allWritten()) {
+            bool progress = false;
+            for (auto &slotPtr : slots) {
+                FileSlot &s = *slotPtr;
+                FileBlock* block = nullptr;
+                while (!s.endMarker && s.outFull.tryPop(block)) {
+                    progress = true;
+                    if (!s.outputOpened) {
+                        s.outputOpened = true;
+                        if (!createOutputFile(s.task->outputPath, s.output)) s.writeFailed.store(true, std::memory_order_relaxed);
+                        s.outputPreallocated = s.output.fd != -1 && preallocateFile(s.output.fd, s.task->outputSizeHint);
+                        s.outputAsync = writeRing && s.output.fd != -1 && getFileSize(s.output.fd) >= 0;
+                        s.writeOffset = 0;
+                    }
+                    if (block->last) {
+                        s.endMarker = block;
+                        break;
+                    }
+                    if (s.writeFailed.load(std::memory_order_relaxed) || block->data.empty()) {
+                        recycle(s, block);
+                        continue;
+                    }
+                    if (s.outputAsync) {
+                        block->offset = s.writeOffset;
+                        block->done = 0;
+                        s.writeOffset += static_cast<long long>(block->data.size());
+                        if (writeRing->prepareWrite(s.output.fd, block->data.data(), static_cast<unsigned>(block->data.size()),
+                                                    block->offset, reinterpret_cast<uint64_t>(block), block->bufferIndex)) {
+                            ++s.writesInFlight;
+                            continue;
+                        }
+                        // Cola llena: escribir este bloque directamente en su posición
+                        if (writeFileAt(s.output.fd, block->data.data(), block->data.size(), block->offset) == -1) {
+                            s.writeFailed.store(true, std::memory_order_relaxed);
+                        }
+                    } else if (writeAll(s.output.fd, block->data.data(), block->data.size()) == -1) {
+                        s.writeFailed.store(true, std::memory_order_relaxed);
+                    }
+                    recycle(s, block);
+                }
+            }
+
+            if (writeRing) {
+                writeRing->submit();
+                uint64_t userData;
+                int result;
+                while (writeRing->popCompletion(userData, result)) {
+                    FileBlock* block = reinterpret_cast<FileBlock*>(userData);
+                    FileSlot &s = *block->slot;
+                    progress = true;
+                    if (result <= 0) {
+                        errno = result < 0 ? -result : EIO;
+                        perror("Error al escribir en el archivo");
+                        s.writeFailed.store(true, std::memory_order_relaxed);
+                    } else if (block->done + static_cast<size_t>(result) < block->data.size()) {
+                        // Escritura parcial: enviar el resto
+                        block->done += static_cast<size_t>(result);
+                        const uint8_t* rest = block->data.data() + block->done;
+                        size_t left = block->data.size() - block->done;
+                        long long at = block->offset + static_cast<long long>(block->done);
+                        if (writeRing->prepareWrite(s.output.fd, rest, static_cast<unsigned>(left), at, userData)) continue;
+                        if (writeFileAt(s.output.fd, rest, left, at) == -1) s.writeFailed.store(true, std::memory_order_relaxed);
+                    }
+                    --s.writesInFlight;
+                    recycle(s, block);
+                }
+            }
+
+            for (auto &slotPtr : slots) {
+                FileSlot &s = *slotPtr;
+                if (!s.endMarker || s.writesInFlight > 0) continue;
+                FileBlock* block = s.endMarker;
+                s.endMarker = nullptr;
+                progress = true;
+                bool ok = !block->failed && !s.writeFailed.load(std::memory_order_relaxed);
+                if (s.outputPreallocated) trimPreallocation(s.output.fd);
+                // Solo una salida completa llega a su ruta final
+                if (ok) ok = commitOutputFile(s.output);
+                else abortOutputFile(s.output);
+                done(*s.task, ok);
+                delete s.task;
+                s.task = nullptr;
+                s.outputOpened = false;
+                s.outputPreallocated = false;
+                s.writeFailed.store(false, std::memory_order_relaxed);
+                block->last = false;
+                recycle(s, block);
+                ++finished;
+                // Desde aquí el lector puede reutilizar el slot
+                freeSlots.tryPush(&s);
+                readerParker.notify();
+            }
+
+            if (!progress && !allWritten()) {
+                if (writeRing && writeRing->inFlight() > 0) {
+                    writeRing->submit(1); // esperar a que termine alguna escritura
+                    continue;
+                }
+                writerParker.wait([&] {
+                    for (auto &slotPtr : slots) {
+                        if (!slotPtr->outFull.empty()) return true;
+                    }
+                    return allWritten();
+                });
+            }
+        }
+    };
+
+    // Cómputo: los archivos directos (los grandes) apenas llegan, si no los que trae el lector.
+    // Solo los workers con índice < activeLimit (ajuste automático) menos los workers del
+    // pool que ocupan los bloques de los directos toman archivos del lector: mientras un
+    // archivo grande usa el pool, los pequeños nuevos esperan en lugar de competir por las CPUs
+    std::unique_ptr<WorkerStats[]> stats(new WorkerStats[workers]);
+    std::atomic<size_t> activeLimit(workers);
+    auto mayStream = [&](size_t worker) {
+        return worker + blockWorkersInUse() < activeLimit.load();
+    };
+
+    auto computeLoop = [&](size_t worker) {
+        pinWorkerThread(worker);
+        WorkerStats &own = stats[worker];
+        while (true) {
+            FileTask* direct = nullptr;
+            FileSlot* slot = nullptr;
+            std::string ahead;
+            auto popDirect = [&] {
+                std::lock_guard<std::mutex> lock(directMutex);
+                if (directQueue.empty()) return false;
+                direct = directQueue.front();
+                directQueue.pop_front();
+                directPending.fetch_sub(1);
+                // El archivo que tomará este worker después (los demás toman los intermedios)
+                if (directQueue.size() >= workers) ahead = directQueue[workers - 1]->inputPath;
+                return true;
+            };
+            workParker.wait([&] {
+                return popDirect() || (mayStream(worker) && readySlots.tryPop(slot)) ||
+                       (readerDone.load() && directPending.load() == 0 && claimed.load() >= dispatched.load());
+            });
+
+            if (direct) {
+                readerParker.notify(); // hay lugar para repartir más directos
+                if (getIoPolicy().prefetchFiles > 0 && !ahead.empty() && ahead != "-") {
+                    prefetchFile(ahead, getIoPolicy().prefetchBytes);
+                }
+                bool ok = job(*direct, nullptr, nullptr);
+                done(*direct, ok);
+                delete direct;
+                workParker.notify(); // sus workers del pool quedaron libres para los pequeños
+                continue;
+            }
+            if (!slot) break;
+            claimed.fetch_add(1);
+            if (readerDone.load()) workParker.notify(); // puede ser el último: que los demás terminen
+
+            own.markNs = nowNs();
+            SlotSource source(*slot, readerParker, own);
+            SlotSink sink(*slot, writerParker, own);
+            bool ok = job(*slot->task, &source, &sink);
+            source.drain();
+            sink.finish(ok && !source.failed());
+            markBusy(own);
+        }
+    };
+
+    // Control por hill-climbing: cada TUNE_INTERVAL mide el throughput (bytes de entrada
+    // por segundo) y guarda el mejor visto en cada nivel. Solo se quitan hilos si los
+    // activos pasan la mayor parte del tiempo esperando al lector o al escritor (la carga
+    // es de E/S) y el nivel de abajo no fue claramente peor; se vuelve a subir si el nivel
+    // de arriba rindió claramente más. Una carga de CPU se queda con todos los hilos.
+    std::mutex tuneMutex;
+    std::condition_variable tuneCv;
+    bool streamingDone = false;
+
+    auto tunerLoop = [&]() {
+        size_t level = workers;
+        std::vector<double> best(workers + 2, -1.0); // mejor throughput por nivel (-1: sin medir)
+        uint64_t lastTime = nowNs(), lastBytes = 0, lastWork = 0;
+
+        std::unique_lock<std::mutex> lock(tuneMutex);
+        while (!tuneCv.wait_for(lock, TUNE_INTERVAL, [&] { return streamingDone; })) {
+            uint64_t bytes = 0, work = 0;
+            for (size_t i = 0; i < workers; ++i) {
+                bytes += stats[i].bytes.load(std::memory_order_relaxed);
+                work += stats[i].busyNs.load(std::memory_order_relaxed);
+            }
+            if (bytes - lastBytes < TUNE_MIN_BYTES) continue; // muy pocos datos para decidir
+
+            uint64_t now = nowNs();
+            double seconds = (now - lastTime) / 1e9;
+            double rate = (bytes - lastBytes) / seconds;
+            double utilization = (work - std::min(work, lastWork)) / 1e9 / (seconds * level);
+
+            best[level] = std::max(best[level], rate);
+
+            size_t next = level;
+            if (level < workers && best[level + 1] > best[level] * (1.0 + TUNE_TOLERANCE)) {
+                next = level + 1;
+            } else if (utilization < TUNE_IO_BOUND && level > 1 &&
+                       !(best[level - 1] >= 0 && best[level - 1] < best[level] * (1.0 - TUNE_TOLERANCE))) {
+                next = level - 1;
+            }
+            if (next != level) {
+                level = next;
+                activeLimit.store(level);
+                workParker.notify();
+            }
+            lastTime = now;
+            lastBytes = bytes;
+            lastWork = work;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    std::thread tuner;
+    threads.emplace_back(readerLoop);
+    threads.emplace_back(writerLoop);
+    if (adaptive_ && workers > 1) tuner = std::thread(tunerLoop);
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back(computeLoop, i);
+    }
+    for (auto &t : threads) t.join();
+
+    if (tuner.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(tuneMutex);
+            streamingDone = true;
+        }
+        tuneCv.notify_all();
+        tuner.join();
+    }
+    chosenThreads_ = activeLimit.load();
+    queue.consumer_.store(nullptr);
+}
+
+// --- Bloques independientes ---
+
+static std::atomic<size_t> blockWorkers(0);
+
+size_t StagedExecutor::blockWorkersInUse() {
+    return blockWorkers.load(std::memory_order_relaxed);
+}
+
+bool StagedExecutor::runBlocks(size_t count, const BlockTask &task) {
+    if (count == 0) return true;
+
+    struct Block {
+        size_t index = 0;
+        const uint8_t* input = nullptr;
+        ByteBuffer inBuffer;
+        ByteBuffer outBuffer;
+    };
+
+    // Los bloques se calculan en el pool compartido, así que varios archivos grandes
+    // procesados a la vez no multiplican los hilos. Dos bloques por worker (uno en
+    // proceso y otro esperando) más los del lector y el escritor.
+    ThreadPool &pool = ThreadPool::shared();
+    const size_t workers = std::min(pool.getThreadCount(), count);
+    blockWorkers.fetch_add(workers);
+    const size_t blockCount = 2 * workers + 2;
+    std::vector<Block> blocks(blockCount);
+    BoundedQueue<Block*> freeBlocks(blockCount), doneBlocks(blockCount);
+    for (auto &b : blocks) freeBlocks.tryPush(&b);
+
+    Parker readerParker, writerParker;
+    std::atomic<bool> failed(false);
+    const bool hasOutput = static_cast<bool>(task.write);
+
+    auto fail = [&]() {
+        failed.store(true);
+        readerParker.notify();
+        writerParker.notify();
+    };
+
+    // Tarea del pool: procesa un bloque y lo pasa al escritor (o lo devuelve al lector)
+    auto computeBlock = [&](Block* b) {
+        b->outBuffer.clear();
+        if (failed.load() || !task.compute(b->index, b->input, b->outBuffer)) {
+            fail();
+        } else if (hasOutput) {
+            doneBlocks.tryPush(b);
+            writerParker.notify();
+        } else {
+            freeBlocks.tryPush(b);
+            readerParker.notify();
+        }
+    };
+
+    // Los bloques terminan en cualquier orden pero se escriben en orden de índice. Todos
+    // los bloques en vuelo caen en [written, written + blockCount), así que un anillo basta.
+    auto writerLoop = [&]() {
+        std::vector<Block*> pending(blockCount, nullptr);
+        for (size_t written = 0; written < count; ++written) {
+            Block* &slot = pending[written % blockCount];
+            while (!slot) {
+                Block* b = nullptr;
+                writerParker.wait([&] { return doneBlocks.tryPop(b) || failed.load(); });
+                if (!b) return;
+                pending[b->index % blockCount] = b;
+            }
+            Block* b = slot;
+            slot = nullptr;
+            if (!task.write(b->index, b->outBuffer.data(), b->outBuffer.size())) {
+                fail();
+                return;
+            }
+            freeBlocks.tryPush(b);
+            readerParker.notify();
+        }
+    };
+
+    std::thread writer;
+    if (hasOutput) writer = std::thread(writerLoop);
+
+    // Lector (en el hilo que llama): toma un bloque libre, lo llena y lo encola en el pool
+    TaskGroup computing(pool);
+    for (size_t i = 0; i < count && !failed.load(); ++i) {
+        Block* b = nullptr;
+        readerParker.wait([&] { return freeBlocks.tryPop(b) || failed.load(); });
+        if (!b) break;
+        b->index = i;
+        b->input = task.read(i, b->inBuffer);
+        if (!b->input) {
+            fail();
+            break;
+        }
+        computing.run([&computeBlock, b] { computeBlock(b); });
+    }
+
+    // Las tareas encoladas usan variables de este marco: esperar a que terminen todas
+    computing.wait();
+    if (writer.joinable()) writer.join();
+    blockWorkers.fetch_sub(workers);
+    return !failed.load();
+}
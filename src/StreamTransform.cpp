@@ -0,0 +1,63 @@
+#include "StreamTransform.h"
+#include "BufferPool.h"
+#include "fileManager.h"
+
+#include <algorithm>
+
+ssize_t TransformSink::write(const void* buffer, size_t size) {
+    if (!transform_.update(static_cast<const uint8_t*>(buffer), size, next_)) return -1;
+    return static_cast<ssize_t>(size);
+}
+
+bool runTransform(ByteSource &source, StreamTransform &transform, ByteSink &sink) {
+    // Tamaño de cada trozo que se entrega a la transformación
+    const size_t chunk = getIoPolicy().streamBufferSize;
+    if (const uint8_t* view = source.data()) {
+        // Vista contigua: se entregan trozos directamente desde el mapeo
+        size_t total = source.dataSize();
+        for (size_t off = 0; off < total; off += chunk) {
+            size_t len = std::min(chunk, total - off);
+            if (!transform.update(view + off, len, sink)) return false;
+        }
+        return transform.finish(sink);
+    }
+
+    PooledBuffer buffer(chunk);
+    buffer->resize(chunk);
+    while (true) {
+        ssize_t n = source.read(buffer->data(), buffer->size());
+        if (n == -1) return false;
+        if (n == 0) break;
+        if (!transform.update(buffer->data(), static_cast<size_t>(n), sink)) return false;
+    }
+    return transform.finish(sink);
+}
+
+bool runTransformChain(ByteSource &source, const std::vector<StreamTransform*> &transforms, ByteSink &sink) {
+    if (transforms.empty()) {
+        const size_t chunk = getIoPolicy().streamBufferSize;
+        PooledBuffer buffer(chunk);
+        buffer->resize(chunk);
+        ssize_t n;
+        while ((n = source.read(buffer->data(), buffer->size())) > 0) {
+            if (sink.write(buffer->data(), static_cast<size_t>(n)) == -1) return false;
+        }
+        return n == 0;
+    }
+
+    // Construir la cadena desde el final: la salida de cada transformación es la
+    // entrada de la siguiente a través de un TransformSink
+    std::vector<std::unique_ptr<TransformSink>> links;
+    ByteSink* next = &sink;
+    for (size_t i = transforms.size() - 1; i > 0; --i) {
+        links.emplace_back(new TransformSink(*transforms[i], *next));
+        next = links.back().get();
+    }
+    if (!runTransform(source, *transforms[0], *next)) return false;
+
+    // Propagar el fin de datos en orden: links está de la última a la segunda transformación
+    for (auto it = links.rbegin(); it != links.rend(); ++it) {
+        if (!(*it)->finish()) return false;
+    }
+    return true;
+}
@@ -1,29 +1,74 @@
 #include "ThreadPool.h"
+#include "cpuAffinity.h"
 #include <iostream>
 
-ThreadPool::ThreadPool(size_t numThreads) 
-    : stop(false), activeTasks(0) {
-    
-    // Si no se especifica, usar hardware_concurrency
+// Worker del pool que ejecuta el hilo actual (nullptr fuera de cualquier pool)
+struct CurrentWorker {
+    ThreadPool* pool;
+    size_t index;
+};
+static thread_local CurrentWorker currentWorker = {nullptr, 0};
+
+// Capacidad de la cola compartida en modo SharedRing
+static constexpr size_t RING_CAPACITY = 4096;
+
+#ifdef THREADPOOL_RING_QUEUE
+static std::atomic<ThreadPool::QueueKind> defaultKind(ThreadPool::QueueKind::SharedRing);
+#else
+static std::atomic<ThreadPool::QueueKind> defaultKind(ThreadPool::QueueKind::WorkStealing);
+#endif
+
+ThreadPool::QueueKind ThreadPool::defaultQueueKind() {
+    return defaultKind.load();
+}
+
+void ThreadPool::setDefaultQueueKind(QueueKind kind) {
+    defaultKind.store(kind);
+}
+
+static std::atomic<size_t> defaultThreads(0);
+
+size_t ThreadPool::defaultThreadCount() {
+    size_t count = defaultThreads.load();
+    if (count == 0) count = availableCpus().size();
+    if (count == 0) count = std::thread::hardware_concurrency();
+    if (count == 0) count = 4; // Fallback
+    return count;
+}
+
+void ThreadPool::setDefaultThreadCount(size_t count) {
+    defaultThreads.store(count);
+}
+
+ThreadPool::ThreadPool(size_t numThreads, QueueKind kind)
+    : kind(kind), pending(0), activeTasks(0), nextInbox(0), stop(false) {
+
+    // Si no se especifica, usar la cantidad por defecto
     if (numThreads == 0) {
-        numThreads = std::thread::hardware_concurrency();
-        if (numThreads == 0) numThreads = 4; // Fallback
+        numThreads = defaultThreadCount();
+    }
+
+    // Las colas deben existir antes de que cualquier worker intente robar
+    if (kind == QueueKind::SharedRing) {
+        ring.reset(new BoundedQueue<Task*>(RING_CAPACITY));
+    } else {
+        queues.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            queues.emplace_back(new WorkerQueues());
+        }
     }
 
     // Crear los hilos worker
     workers.reserve(numThreads);
     for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back(&ThreadPool::workerThread, this);
+        workers.emplace_back(&ThreadPool::workerThread, this, i);
     }
 }
 
 ThreadPool::~ThreadPool() {
-    {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        stop = true;
-    }
-    condition.notify_all();
-    
+    stop = true;
+    idle.notify();
+
     for (std::thread& worker : workers) {
         if (worker.joinable()) {
             worker.join();
@@ -31,58 +76,210 @@ ThreadPool::~ThreadPool() {
     }
 }
 
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
 void ThreadPool::enqueue(std::function<void()> task) {
-    {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        if (stop) {
-            throw std::runtime_error("Cannot enqueue on stopped ThreadPool");
+    if (stop) {
+        throw std::runtime_error("Cannot enqueue on stopped ThreadPool");
+    }
+    Task* t = new Task(std::move(task));
+    activeTasks++;
+    pending++;
+
+    if (kind == QueueKind::SharedRing) {
+        if (!ring->tryPush(t)) {
+            if (currentWorker.pool == this) {
+                // Cola llena y quien encola es un worker: esperar podría bloquear a todos
+                pending--;
+                runTask(t);
+                finishTask();
+                return;
+            }
+            ringNotFull.wait([&] { return ring->tryPush(t); });
         }
-        tasks.push(std::move(task));
-        activeTasks++;
+    } else if (currentWorker.pool == this) {
+        // Desde un worker: a su propio deque, sin locks
+        queues[currentWorker.index]->local.push(t);
+    } else {
+        WorkerQueues &q = *queues[nextInbox.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+        std::lock_guard<std::mutex> lock(q.inboxMutex);
+        q.inbox.push_back(t);
+        q.inboxSize.fetch_add(1, std::memory_order_release);
     }
-    condition.notify_one();
+    idle.notify();
 }
 
 void ThreadPool::waitForCompletion() {
-    while (true) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        if (tasks.empty() && activeTasks == 0) {
-            break;
-        }
-        lock.unlock();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [this] { return activeTasks == 0; });
+}
+
+ThreadPool::Task* ThreadPool::popInbox(WorkerQueues &q) {
+    if (q.inboxSize.load(std::memory_order_acquire) == 0) return nullptr;
+    std::lock_guard<std::mutex> lock(q.inboxMutex);
+    if (q.inbox.empty()) return nullptr;
+    Task* t = q.inbox.front();
+    q.inbox.pop_front();
+    q.inboxSize.fetch_sub(1, std::memory_order_relaxed);
+    return t;
+}
+
+ThreadPool::Task* ThreadPool::findTask(size_t index, uint64_t &rng) {
+    if (kind == QueueKind::SharedRing) {
+        Task* t = nullptr;
+        if (!ring->tryPop(t)) return nullptr;
+        ringNotFull.notify();
+        return t;
+    }
+
+    WorkerQueues &own = *queues[index];
+    if (Task* t = own.local.take()) return t;
+    if (Task* t = popInbox(own)) return t;
+
+    // Robar: víctima inicial al azar (xorshift) para que los ladrones no choquen siempre
+    // contra el mismo worker
+    size_t n = queues.size();
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    size_t start = static_cast<size_t>(rng % n);
+    for (size_t k = 0; k < n; ++k) {
+        size_t v = (start + k) % n;
+        if (v == index) continue;
+        if (Task* t = queues[v]->local.steal()) return t;
+        if (Task* t = popInbox(*queues[v])) return t;
+    }
+    return nullptr;
+}
+
+void ThreadPool::runTask(Task* task) {
+    try {
+        (*task)();
+    } catch (const std::exception& e) {
+        std::cerr << "Error en worker thread: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Error desconocido en worker thread" << std::endl;
+    }
+    delete task;
+}
+
+bool ThreadPool::runPendingTask() {
+    if (currentWorker.pool != this) return false;
+    static thread_local uint64_t rng = 0x2545F4914F6CDD1DULL;
+    Task* task = findTask(currentWorker.index, rng);
+    if (!task) return false;
+    pending--;
+    runTask(task);
+    finishTask();
+    return true;
+}
+
+void ThreadPool::finishTask() {
+    // Solo el último toma el mutex: waitForCompletion no puede perder el aviso
+    if (--activeTasks == 0) {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        doneCondition.notify_all();
     }
 }
 
-void ThreadPool::workerThread() {
+void ThreadPool::workerThread(size_t index) {
+    currentWorker = {this, index};
+    uint64_t rng = 0x9E3779B97F4A7C15ULL * (index + 1);
+
     while (true) {
-        std::function<void()> task;
-        
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            condition.wait(lock, [this] { 
-                return stop || !tasks.empty(); 
-            });
-            
-            if (stop && tasks.empty()) {
+        Task* task = findTask(index, rng);
+        if (!task) {
+            // Sin trabajo visible: esperar a que se encole algo o a que el pool se detenga
+            idle.wait([this] { return pending.load() > 0 || stop.load(); });
+            if (stop && pending == 0) {
                 return;
             }
-            
-            if (!tasks.empty()) {
-                task = std::move(tasks.front());
-                tasks.pop();
-            }
+            continue;
         }
-        
-        if (task) {
-            try {
-                task();
-            } catch (const std::exception& e) {
-                std::cerr << "Error en worker thread: " << e.what() << std::endl;
-            } catch (...) {
-                std::cerr << "Error desconocido en worker thread" << std::endl;
-            }
-            activeTasks--;
+        pending--;
+        runTask(task);
+        finishTask();
+    }
+}
+
+// --- TaskGroup ---
+
+struct TaskGroup::Node {
+    std::function<void()> task;
+    std::mutex mutex;                   // Protege done y successors
+    bool done = false;
+    std::vector<TaskRef> successors;    // Tareas que esperan a esta
+    std::atomic<size_t> waiting{1};     // Dependencias sin terminar (+1 mientras se agrega)
+};
+
+TaskGroup::TaskGroup(ThreadPool &pool) : pool_(pool), outstanding_(0) {}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+TaskGroup::TaskRef TaskGroup::run(std::function<void()> task, const std::vector<TaskRef> &dependencies) {
+    TaskRef node = std::make_shared<Node>();
+    node->task = std::move(task);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++outstanding_;
+    }
+    for (const TaskRef &dep : dependencies) {
+        if (!dep) continue;
+        std::lock_guard<std::mutex> lock(dep->mutex);
+        if (!dep->done) {
+            dep->successors.push_back(node);
+            node->waiting++;
+        }
+    }
+    // Soltar la referencia propia: si no quedan dependencias pendientes, se encola ya
+    if (--node->waiting == 0) schedule(node);
+    return node;
+}
+
+void TaskGroup::schedule(const TaskRef &node) {
+    pool_.enqueue([this, node] {
+        try {
+            node->task();
+        } catch (const std::exception& e) {
+            std::cerr << "Error en worker thread: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Error desconocido en worker thread" << std::endl;
         }
+        complete(node);
+    });
+}
+
+void TaskGroup::complete(const TaskRef &node) {
+    std::vector<TaskRef> ready;
+    {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        node->done = true;
+        ready.swap(node->successors);
+    }
+    node->task = nullptr; // liberar capturas cuanto antes
+    // Encolar las sucesoras antes de descontar esta tarea, para que wait() no
+    // vea el grupo vacío mientras todavía quedan tareas por correr
+    for (const TaskRef &next : ready) {
+        if (--next->waiting == 0) schedule(next);
+    }
+    // Bajo el mutex: una vez descontada, quien espera puede destruir el grupo
+    std::lock_guard<std::mutex> lock(mutex_);
+    --outstanding_;
+    changed_.notify_all();
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (outstanding_ > 0) {
+        // Desde un worker: ayudar con tareas pendientes en lugar de bloquear el hilo
+        lock.unlock();
+        bool ran = pool_.runPendingTask();
+        lock.lock();
+        if (!ran && outstanding_ > 0) changed_.wait(lock);
     }
 }
@@ -0,0 +1,552 @@
+#include "aes.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AES_HAVE_X86 1
+#endif
+
+// --- Tablas compartidas ---
+
+static const uint8_t AES_RCON[11] = {0x00,0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x1B,0x36};
+
+// --- Backend bitsliced ---
+// Cada "plano" q[i] contiene el bit i de todos los bytes de varios bloques.
+// Con uint64_t caben 4 bloques; con un vector de 128 bits (SSE2) caben 8.
+// Todas las operaciones son lógicas, sin accesos a memoria dependientes de datos.
+
+typedef uint64_t bsword __attribute__((vector_size(16)));
+
+// S-box como circuito booleano (Boyar–Peralta), válido para cualquier tipo de palabra
+template <typename W>
+static inline void bsSbox(W* q) {
+	W x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4];
+	W x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+	// Transformación lineal superior
+	W y14 = x3 ^ x5;
+	W y13 = x0 ^ x6;
+	W y9 = x0 ^ x3;
+	W y8 = x0 ^ x5;
+	W t0 = x1 ^ x2;
+	W y1 = t0 ^ x7;
+	W y4 = y1 ^ x3;
+	W y12 = y13 ^ y14;
+	W y2 = y1 ^ x0;
+	W y5 = y1 ^ x6;
+	W y3 = y5 ^ y8;
+	W t1 = x4 ^ y12;
+	W y15 = t1 ^ x5;
+	W y20 = t1 ^ x1;
+	W y6 = y15 ^ x7;
+	W y10 = y15 ^ t0;
+	W y11 = y20 ^ y9;
+	W y7 = x7 ^ y11;
+	W y17 = y10 ^ y11;
+	W y19 = y10 ^ y8;
+	W y16 = t0 ^ y11;
+	W y21 = y13 ^ y16;
+	W y18 = x0 ^ y16;
+
+	// Sección no lineal (inversión en GF(2^8))
+	W t2 = y12 & y15;
+	W t3 = y3 & y6;
+	W t4 = t3 ^ t2;
+	W t5 = y4 & x7;
+	W t6 = t5 ^ t2;
+	W t7 = y13 & y16;
+	W t8 = y5 & y1;
+	W t9 = t8 ^ t7;
+	W t10 = y2 & y7;
+	W t11 = t10 ^ t7;
+	W t12 = y9 & y11;
+	W t13 = y14 & y17;
+	W t14 = t13 ^ t12;
+	W t15 = y8 & y10;
+	W t16 = t15 ^ t12;
+	W t17 = t4 ^ t14;
+	W t18 = t6 ^ t16;
+	W t19 = t9 ^ t14;
+	W t20 = t11 ^ t16;
+	W t21 = t17 ^ y20;
+	W t22 = t18 ^ y19;
+	W t23 = t19 ^ y21;
+	W t24 = t20 ^ y18;
+
+	W t25 = t21 ^ t22;
+	W t26 = t21 & t23;
+	W t27 = t24 ^ t26;
+	W t28 = t25 & t27;
+	W t29 = t28 ^ t22;
+	W t30 = t23 ^ t24;
+	W t31 = t22 ^ t26;
+	W t32 = t31 & t30;
+	W t33 = t32 ^ t24;
+	W t34 = t23 ^ t33;
+	W t35 = t27 ^ t33;
+	W t36 = t24 & t35;
+	W t37 = t36 ^ t34;
+	W t38 = t27 ^ t36;
+	W t39 = t29 & t38;
+	W t40 = t25 ^ t39;
+
+	W t41 = t40 ^ t37;
+	W t42 = t29 ^ t33;
+	W t43 = t29 ^ t40;
+	W t44 = t33 ^ t37;
+	W t45 = t42 ^ t41;
+	W z0 = t44 & y15;
+	W z1 = t37 & y6;
+	W z2 = t33 & x7;
+	W z3 = t43 & y16;
+	W z4 = t40 & y1;
+	W z5 = t29 & y7;
+	W z6 = t42 & y11;
+	W z7 = t45 & y17;
+	W z8 = t41 & y10;
+	W z9 = t44 & y12;
+	W z10 = t37 & y3;
+	W z11 = t33 & y4;
+	W z12 = t43 & y13;
+	W z13 = t40 & y5;
+	W z14 = t29 & y2;
+	W z15 = t42 & y9;
+	W z16 = t45 & y14;
+	W z17 = t41 & y8;
+
+	// Transformación lineal inferior
+	W t46 = z15 ^ z16;
+	W t47 = z10 ^ z11;
+	W t48 = z5 ^ z13;
+	W t49 = z9 ^ z10;
+	W t50 = z2 ^ z12;
+	W t51 = z2 ^ z5;
+	W t52 = z7 ^ z8;
+	W t53 = z0 ^ z3;
+	W t54 = z6 ^ z7;
+	W t55 = z16 ^ z17;
+	W t56 = z12 ^ t48;
+	W t57 = t50 ^ t53;
+	W t58 = z4 ^ t46;
+	W t59 = z3 ^ t54;
+	W t60 = t46 ^ t57;
+	W t61 = z14 ^ t57;
+	W t62 = t52 ^ t58;
+	W t63 = t49 ^ t58;
+	W t64 = z4 ^ t59;
+	W t65 = t61 ^ t62;
+	W t66 = z1 ^ t63;
+	W s0 = t59 ^ t63;
+	W s6 = t56 ^ ~t62;
+	W s7 = t48 ^ ~t60;
+	W t67 = t64 ^ t65;
+	W s3 = t53 ^ t66;
+	W s4 = t51 ^ t66;
+	W s5 = t47 ^ t65;
+	W s1 = t64 ^ ~s3;
+	W s2 = t55 ^ ~t67;
+
+	q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+	q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+// Transformación afín inversa (incluye la constante 0x63) usada por la S-box inversa
+template <typename W>
+static inline void bsInvAffine(W* q) {
+	W q0 = ~q[0], q1 = ~q[1], q2 = q[2], q3 = q[3];
+	W q4 = q[4], q5 = ~q[5], q6 = ~q[6], q7 = q[7];
+	q[7] = q1 ^ q4 ^ q6;
+	q[6] = q0 ^ q3 ^ q5;
+	q[5] = q7 ^ q2 ^ q4;
+	q[4] = q6 ^ q1 ^ q3;
+	q[3] = q5 ^ q0 ^ q2;
+	q[2] = q4 ^ q7 ^ q1;
+	q[1] = q3 ^ q6 ^ q0;
+	q[0] = q2 ^ q5 ^ q7;
+}
+
+// S-box inversa: A^-1 ∘ S ∘ A^-1 (reutiliza el circuito directo)
+template <typename W>
+static inline void bsInvSbox(W* q) {
+	bsInvAffine(q);
+	bsSbox(q);
+	bsInvAffine(q);
+}
+
+template <typename W>
+static inline void bsAddRoundKey(W* q, const W* rk) {
+	for (int i = 0; i < 8; ++i) q[i] ^= rk[i];
+}
+
+// Cada fila ocupa 16 bits de la palabra (4 columnas x 4 bloques)
+template <typename W>
+static inline void bsShiftRows(W* q) {
+	for (int i = 0; i < 8; ++i) {
+		W x = q[i];
+		q[i] = (x & 0x000000000000FFFFull)
+			| ((x & 0x00000000FFF00000ull) >> 4)
+			| ((x & 0x00000000000F0000ull) << 12)
+			| ((x & 0x0000FF0000000000ull) >> 8)
+			| ((x & 0x000000FF00000000ull) << 8)
+			| ((x & 0xF000000000000000ull) >> 12)
+			| ((x & 0x0FFF000000000000ull) << 4);
+	}
+}
+
+template <typename W>
+static inline void bsInvShiftRows(W* q) {
+	for (int i = 0; i < 8; ++i) {
+		W x = q[i];
+		q[i] = (x & 0x000000000000FFFFull)
+			| ((x & 0x000000000FFF0000ull) << 4)
+			| ((x & 0x00000000F0000000ull) >> 12)
+			| ((x & 0x000000FF00000000ull) << 8)
+			| ((x & 0x0000FF0000000000ull) >> 8)
+			| ((x & 0x000F000000000000ull) << 12)
+			| ((x & 0xFFF0000000000000ull) >> 4);
+	}
+}
+
+template <typename W>
+static inline W bsRotr16(W x) { return (x >> 16) | (x << 48); }
+
+template <typename W>
+static inline W bsRotr32(W x) { return (x >> 32) | (x << 32); }
+
+// Multiplicación por {02} en representación bitsliced
+template <typename W>
+static inline void bsXtime(const W* x, W* out) {
+	out[0] = x[7];
+	out[1] = x[0] ^ x[7];
+	out[2] = x[1];
+	out[3] = x[2] ^ x[7];
+	out[4] = x[3] ^ x[7];
+	out[5] = x[4];
+	out[6] = x[5];
+	out[7] = x[6];
+}
+
+// MixColumns: out_i = {02}(a_i ^ a_{i+1}) ^ a_{i+1} ^ a_{i+2} ^ a_{i+3}
+template <typename W>
+static inline void bsMixColumns(W* q) {
+	W r[8], s[8], d[8];
+	for (int i = 0; i < 8; ++i) {
+		r[i] = bsRotr16(q[i]);
+		s[i] = q[i] ^ r[i];
+	}
+	bsXtime(s, d);
+	for (int i = 0; i < 8; ++i) q[i] = d[i] ^ r[i] ^ bsRotr32(s[i]);
+}
+
+// InvMixColumns = MixColumns precedido de a_i ^= {04}(a_i ^ a_{i+2})
+template <typename W>
+static inline void bsInvMixColumns(W* q) {
+	W t[8], t2[8], t4[8];
+	for (int i = 0; i < 8; ++i) t[i] = q[i] ^ bsRotr32(q[i]);
+	bsXtime(t, t2);
+	bsXtime(t2, t4);
+	for (int i = 0; i < 8; ++i) q[i] ^= t4[i];
+	bsMixColumns(q);
+}
+
+template <typename W>
+static inline void bsSwap(W &x, W &y, uint64_t cl, uint64_t ch, int s) {
+	W a = x, b = y;
+	x = (a & cl) | ((b & cl) << s);
+	y = ((a & ch) >> s) | (b & ch);
+}
+
+// Transposición de bits (involutiva): bytes <-> planos de bits
+template <typename W>
+static inline void bsOrtho(W* q) {
+	bsSwap(q[0], q[1], 0x5555555555555555ull, 0xAAAAAAAAAAAAAAAAull, 1);
+	bsSwap(q[2], q[3], 0x5555555555555555ull, 0xAAAAAAAAAAAAAAAAull, 1);
+	bsSwap(q[4], q[5], 0x5555555555555555ull, 0xAAAAAAAAAAAAAAAAull, 1);
+	bsSwap(q[6], q[7], 0x5555555555555555ull, 0xAAAAAAAAAAAAAAAAull, 1);
+
+	bsSwap(q[0], q[2], 0x3333333333333333ull, 0xCCCCCCCCCCCCCCCCull, 2);
+	bsSwap(q[1], q[3], 0x3333333333333333ull, 0xCCCCCCCCCCCCCCCCull, 2);
+	bsSwap(q[4], q[6], 0x3333333333333333ull, 0xCCCCCCCCCCCCCCCCull, 2);
+	bsSwap(q[5], q[7], 0x3333333333333333ull, 0xCCCCCCCCCCCCCCCCull, 2);
+
+	bsSwap(q[0], q[4], 0x0F0F0F0F0F0F0F0Full, 0xF0F0F0F0F0F0F0F0ull, 4);
+	bsSwap(q[1], q[5], 0x0F0F0F0F0F0F0F0Full, 0xF0F0F0F0F0F0F0F0ull, 4);
+	bsSwap(q[2], q[6], 0x0F0F0F0F0F0F0F0Full, 0xF0F0F0F0F0F0F0F0ull, 4);
+	bsSwap(q[3], q[7], 0x0F0F0F0F0F0F0F0Full, 0xF0F0F0F0F0F0F0F0ull, 4);
+}
+
+static inline uint32_t loadLE32(const uint8_t* p) {
+	return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+		| (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline void storeLE32(uint8_t* p, uint32_t v) {
+	p[0] = static_cast<uint8_t>(v); p[1] = static_cast<uint8_t>(v >> 8);
+	p[2] = static_cast<uint8_t>(v >> 16); p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+// Intercala 4 palabras de 32 bits (una columna de 4 bloques) en dos palabras de 64 bits
+static inline void bsInterleaveIn(uint64_t &q0, uint64_t &q1, const uint32_t* w) {
+	uint64_t x0 = w[0], x1 = w[1], x2 = w[2], x3 = w[3];
+	x0 |= (x0 << 16); x1 |= (x1 << 16); x2 |= (x2 << 16); x3 |= (x3 << 16);
+	x0 &= 0x0000FFFF0000FFFFull; x1 &= 0x0000FFFF0000FFFFull;
+	x2 &= 0x0000FFFF0000FFFFull; x3 &= 0x0000FFFF0000FFFFull;
+	x0 |= (x0 << 8); x1 |= (x1 << 8); x2 |= (x2 << 8); x3 |= (x3 << 8);
+	x0 &= 0x00FF00FF00FF00FFull; x1 &= 0x00FF00FF00FF00FFull;
+	x2 &= 0x00FF00FF00FF00FFull; x3 &= 0x00FF00FF00FF00FFull;
+	q0 = x0 | (x2 << 8);
+	q1 = x1 | (x3 << 8);
+}
+
+static inline void bsInterleaveOut(uint32_t* w, uint64_t q0, uint64_t q1) {
+	uint64_t x0 = q0 & 0x00FF00FF00FF00FFull;
+	uint64_t x1 = q1 & 0x00FF00FF00FF00FFull;
+	uint64_t x2 = (q0 >> 8) & 0x00FF00FF00FF00FFull;
+	uint64_t x3 = (q1 >> 8) & 0x00FF00FF00FF00FFull;
+	x0 |= (x0 >> 8); x1 |= (x1 >> 8); x2 |= (x2 >> 8); x3 |= (x3 >> 8);
+	x0 &= 0x0000FFFF0000FFFFull; x1 &= 0x0000FFFF0000FFFFull;
+	x2 &= 0x0000FFFF0000FFFFull; x3 &= 0x0000FFFF0000FFFFull;
+	w[0] = static_cast<uint32_t>(x0) | static_cast<uint32_t>(x0 >> 16);
+	w[1] = static_cast<uint32_t>(x1) | static_cast<uint32_t>(x1 >> 16);
+	w[2] = static_cast<uint32_t>(x2) | static_cast<uint32_t>(x2 >> 16);
+	w[3] = static_cast<uint32_t>(x3) | static_cast<uint32_t>(x3 >> 16);
+}
+
+// Carga 8 bloques (128 bytes) en representación bitsliced
+static inline void bsLoad8(bsword* q, const uint8_t* in) {
+	uint64_t lanes[2][8];
+	for (int half = 0; half < 2; ++half) {
+		uint32_t w[16];
+		for (int i = 0; i < 16; ++i) w[i] = loadLE32(in + half*64 + i*4);
+		for (int i = 0; i < 4; ++i) bsInterleaveIn(lanes[half][i], lanes[half][i + 4], w + (i << 2));
+	}
+	for (int i = 0; i < 8; ++i) q[i] = bsword{lanes[0][i], lanes[1][i]};
+	bsOrtho(q);
+}
+
+static inline void bsStore8(uint8_t* out, bsword* q) {
+	bsOrtho(q);
+	for (int half = 0; half < 2; ++half) {
+		uint32_t w[16];
+		for (int i = 0; i < 4; ++i) bsInterleaveOut(w + (i << 2), q[i][half], q[i + 4][half]);
+		for (int i = 0; i < 16; ++i) storeLE32(out + half*64 + i*4, w[i]);
+	}
+}
+
+static void bsEncrypt8(const bsword* rk, uint8_t* blocks) {
+	bsword q[8];
+	bsLoad8(q, blocks);
+	bsAddRoundKey(q, rk);
+	for (int round = 1; round <= 9; ++round) {
+		bsSbox(q);
+		bsShiftRows(q);
+		bsMixColumns(q);
+		bsAddRoundKey(q, rk + round*8);
+	}
+	bsSbox(q);
+	bsShiftRows(q);
+	bsAddRoundKey(q, rk + 80);
+	bsStore8(blocks, q);
+}
+
+static void bsDecrypt8(const bsword* rk, uint8_t* blocks) {
+	bsword q[8];
+	bsLoad8(q, blocks);
+	bsAddRoundKey(q, rk + 80);
+	for (int round = 9; round >= 1; --round) {
+		bsInvShiftRows(q);
+		bsInvSbox(q);
+		bsAddRoundKey(q, rk + round*8);
+		bsInvMixColumns(q);
+	}
+	bsInvShiftRows(q);
+	bsInvSbox(q);
+	bsAddRoundKey(q, rk);
+	bsStore8(blocks, q);
+}
+
+// SubWord de tiempo constante: los 4 bytes viajan como columnas de bits en un uint64_t
+static uint32_t bsSubWord(uint32_t word) {
+	uint64_t q[8];
+	for (int bit = 0; bit < 8; ++bit) {
+		uint64_t plane = 0;
+		for (int b = 0; b < 4; ++b) plane |= static_cast<uint64_t>((word >> (b*8 + bit)) & 1u) << b;
+		q[bit] = plane;
+	}
+	bsSbox(q);
+	uint32_t out = 0;
+	for (int bit = 0; bit < 8; ++bit) {
+		for (int b = 0; b < 4; ++b) out |= static_cast<uint32_t>((q[bit] >> b) & 1u) << (b*8 + bit);
+	}
+	return out;
+}
+
+// --- Backend bitsliced (CBC) ---
+
+// CBC encrypt es secuencial (cada bloque depende del anterior): se cifra un bloque a
+// la vez en el carril 0 y los otros 7 van en cero. Cuesta 8 veces el cómputo de un
+// bloque, pero sin accesos a memoria que dependan de la clave o los datos; queda más
+// lento que una implementación por tablas (el README recomienda CHACHA20 sin AES-NI).
+static void bitslicedEncryptCBC(const AesKey &ctx, uint8_t iv[16], uint8_t* data, std::size_t blocks) {
+	const bsword* rk = reinterpret_cast<const bsword*>(ctx.bitslicedKeys);
+	uint8_t group[128];
+	const uint8_t* prev = iv;
+	for (std::size_t b = 0; b < blocks; ++b) {
+		uint8_t* block = data + b*16;
+		for (int i = 0; i < 16; ++i) group[i] = block[i] ^ prev[i];
+		std::memset(group + 16, 0, sizeof(group) - 16);
+		bsEncrypt8(rk, group);
+		std::memcpy(block, group, 16);
+		prev = block;
+	}
+	if (blocks > 0) std::memcpy(iv, prev, 16);
+}
+
+// CBC inverso bitsliced: los bloques cifrados son independientes, se descifran de 8 en 8
+static void bitslicedDecryptCBC(const AesKey &ctx, uint8_t iv[16], uint8_t* data, std::size_t blocks) {
+	const bsword* rk = reinterpret_cast<const bsword*>(ctx.bitslicedKeys);
+	uint8_t cipher[128];
+	uint8_t group[128];
+	for (std::size_t b = 0; b < blocks; b += 8) {
+		std::size_t n = (blocks - b < 8) ? blocks - b : 8;
+		uint8_t* chunk = data + b*16;
+		std::memcpy(cipher, chunk, n*16);
+		std::memcpy(group, chunk, n*16);
+		if (n < 8) std::memset(group + n*16, 0, (8 - n)*16);
+		bsDecrypt8(rk, group);
+		for (std::size_t j = 0; j < n; ++j) {
+			const uint8_t* prev = (j == 0) ? iv : cipher + (j - 1)*16;
+			for (int i = 0; i < 16; ++i) chunk[j*16 + i] = group[j*16 + i] ^ prev[i];
+		}
+		std::memcpy(iv, cipher + (n - 1)*16, 16);
+	}
+}
+
+// --- Backend AES-NI ---
+
+#ifdef AES_HAVE_X86
+__attribute__((target("aes,sse2")))
+static void aesniEncryptCBC(const uint8_t* roundKeys, uint8_t iv[16], uint8_t* data, std::size_t blocks) {
+	__m128i rk[11];
+	for (int i = 0; i < 11; ++i) rk[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + i*16));
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+	for (std::size_t b = 0; b < blocks; ++b) {
+		__m128i* p = reinterpret_cast<__m128i*>(data + b*16);
+		__m128i x = _mm_xor_si128(_mm_loadu_si128(p), prev);
+		x = _mm_xor_si128(x, rk[0]);
+		for (int r = 1; r < 10; ++r) x = _mm_aesenc_si128(x, rk[r]);
+		x = _mm_aesenclast_si128(x, rk[10]);
+		_mm_storeu_si128(p, x);
+		prev = x;
+	}
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+}
+
+__attribute__((target("aes,sse2")))
+static void aesniDecryptCBC(const uint8_t* roundKeys, uint8_t iv[16], uint8_t* data, std::size_t blocks) {
+	// Round keys de desencriptación (Equivalent Inverse Cipher)
+	__m128i dk[11];
+	dk[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + 160));
+	for (int r = 1; r < 10; ++r) {
+		dk[r] = _mm_aesimc_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys + (10 - r)*16)));
+	}
+	dk[10] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(roundKeys));
+
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+	std::size_t b = 0;
+	// 8 bloques en vuelo para ocultar la latencia de aesdec
+	for (; b + 8 <= blocks; b += 8) {
+		__m128i* p = reinterpret_cast<__m128i*>(data + b*16);
+		__m128i c[8], x[8];
+		for (int j = 0; j < 8; ++j) {
+			c[j] = _mm_loadu_si128(p + j);
+			x[j] = _mm_xor_si128(c[j], dk[0]);
+		}
+		for (int r = 1; r < 10; ++r) {
+			for (int j = 0; j < 8; ++j) x[j] = _mm_aesdec_si128(x[j], dk[r]);
+		}
+		for (int j = 0; j < 8; ++j) {
+			x[j] = _mm_aesdeclast_si128(x[j], dk[10]);
+			_mm_storeu_si128(p + j, _mm_xor_si128(x[j], j == 0 ? prev : c[j - 1]));
+		}
+		prev = c[7];
+	}
+	for (; b < blocks; ++b) {
+		__m128i* p = reinterpret_cast<__m128i*>(data + b*16);
+		__m128i c = _mm_loadu_si128(p);
+		__m128i x = _mm_xor_si128(c, dk[0]);
+		for (int r = 1; r < 10; ++r) x = _mm_aesdec_si128(x, dk[r]);
+		x = _mm_aesdeclast_si128(x, dk[10]);
+		_mm_storeu_si128(p, _mm_xor_si128(x, prev));
+		prev = c;
+	}
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(iv), prev);
+}
+#endif
+
+// --- API pública ---
+
+AesBackend aesDetectBackend() {
+#ifdef AES_HAVE_X86
+	static const bool hasAesNi = __builtin_cpu_supports("aes");
+	if (hasAesNi) return AesBackend::AesNi;
+#endif
+	return AesBackend::Bitsliced;
+}
+
+void aesInitKey(AesKey &ctx, const uint8_t key[16], AesBackend backend) {
+#ifndef AES_HAVE_X86
+	if (backend == AesBackend::AesNi) backend = AesBackend::Bitsliced;
+#endif
+	ctx.backend = backend;
+
+	// Key expansion: 16 bytes -> 176 bytes (11 round keys), SubWord de tiempo constante
+	uint8_t* roundKeys = ctx.roundKeys;
+	std::memcpy(roundKeys, key, 16);
+	int rconIter = 1;
+	for (int bytesGenerated = 16; bytesGenerated < 176; bytesGenerated += 4) {
+		uint8_t temp[4];
+		std::memcpy(temp, roundKeys + bytesGenerated - 4, 4);
+		if (bytesGenerated % 16 == 0) {
+			// rotate + subWord + Rcon
+			uint32_t w = loadLE32(temp);
+			w = (w >> 8) | (w << 24);
+			storeLE32(temp, bsSubWord(w));
+			temp[0] ^= AES_RCON[rconIter++];
+		}
+		for (int i = 0; i < 4; ++i) roundKeys[bytesGenerated + i] = roundKeys[bytesGenerated - 16 + i] ^ temp[i];
+	}
+
+	// Round keys bitsliced: cada una replicada en los 8 bloques
+	bsword* bk = reinterpret_cast<bsword*>(ctx.bitslicedKeys);
+	for (int r = 0; r < 11; ++r) {
+		uint8_t rep[128];
+		for (int j = 0; j < 8; ++j) std::memcpy(rep + j*16, roundKeys + r*16, 16);
+		bsLoad8(bk + r*8, rep);
+	}
+}
+
+void aesEncryptCBC(const AesKey &ctx, uint8_t iv[16], uint8_t* data, std::size_t blocks) {
+#ifdef AES_HAVE_X86
+	if (ctx.backend == AesBackend::AesNi) {
+		aesniEncryptCBC(ctx.roundKeys, iv, data, blocks);
+		return;
+	}
+#endif
+	bitslicedEncryptCBC(ctx, iv, data, blocks);
+}
+
+void aesDecryptCBC(const AesKey &ctx, uint8_t iv[16], uint8_t* data, std::size_t blocks) {
+	if (blocks == 0) return;
+	switch (ctx.backend) {
+#ifdef AES_HAVE_X86
+		case AesBackend::AesNi:
+			aesniDecryptCBC(ctx.roundKeys, iv, data, blocks);
+			return;
+#endif
+		default:
+			bitslicedDecryptCBC(ctx, iv, data, blocks);
+			return;
+	}
+}
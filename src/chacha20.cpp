@@ -0,0 +1,235 @@
+#include "chacha20.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CHACHA_HAVE_X86 1
+#endif
+
+// Constantes "expand 32-byte k"
+static const uint32_t CHACHA_SIGMA[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+static inline uint32_t loadLE32(const uint8_t* p) {
+	return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+		| (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline void storeLE32(uint8_t* p, uint32_t v) {
+	p[0] = static_cast<uint8_t>(v); p[1] = static_cast<uint8_t>(v >> 8);
+	p[2] = static_cast<uint8_t>(v >> 16); p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+// Estado inicial con el contador en las palabras 12-13
+static void chachaInitState(uint32_t state[16], const uint8_t key[32], const uint8_t nonce[8], uint64_t counter) {
+	for (int i = 0; i < 4; ++i) state[i] = CHACHA_SIGMA[i];
+	for (int i = 0; i < 8; ++i) state[4 + i] = loadLE32(key + i*4);
+	state[12] = static_cast<uint32_t>(counter);
+	state[13] = static_cast<uint32_t>(counter >> 32);
+	state[14] = loadLE32(nonce);
+	state[15] = loadLE32(nonce + 4);
+}
+
+// --- Kernel escalar: un bloque por iteración ---
+
+static inline uint32_t rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+#define CHACHA_QR(a, b, c, d) \
+	a += b; d ^= a; d = rotl32(d, 16); \
+	c += d; b ^= c; b = rotl32(b, 12); \
+	a += b; d ^= a; d = rotl32(d, 8);  \
+	c += d; b ^= c; b = rotl32(b, 7)
+
+static void chachaBlock(const uint32_t state[16], uint8_t out[64]) {
+	uint32_t x[16];
+	std::memcpy(x, state, sizeof(x));
+	for (int i = 0; i < 10; ++i) {
+		CHACHA_QR(x[0], x[4], x[8],  x[12]);
+		CHACHA_QR(x[1], x[5], x[9],  x[13]);
+		CHACHA_QR(x[2], x[6], x[10], x[14]);
+		CHACHA_QR(x[3], x[7], x[11], x[15]);
+		CHACHA_QR(x[0], x[5], x[10], x[15]);
+		CHACHA_QR(x[1], x[6], x[11], x[12]);
+		CHACHA_QR(x[2], x[7], x[8],  x[13]);
+		CHACHA_QR(x[3], x[4], x[9],  x[14]);
+	}
+	for (int i = 0; i < 16; ++i) storeLE32(out + i*4, x[i] + state[i]);
+}
+
+static inline void chachaIncrement(uint32_t state[16], uint64_t n) {
+	uint64_t c = (static_cast<uint64_t>(state[13]) << 32 | state[12]) + n;
+	state[12] = static_cast<uint32_t>(c);
+	state[13] = static_cast<uint32_t>(c >> 32);
+}
+
+// Procesa los bloques restantes uno a uno (incluido un bloque parcial final)
+static void chachaXorScalar(uint32_t state[16], uint8_t* data, std::size_t len) {
+	uint8_t ks[64];
+	while (len > 0) {
+		chachaBlock(state, ks);
+		std::size_t n = len < 64 ? len : 64;
+		for (std::size_t i = 0; i < n; ++i) data[i] ^= ks[i];
+		chachaIncrement(state, 1);
+		data += n;
+		len -= n;
+	}
+}
+
+#ifdef CHACHA_HAVE_X86
+
+// --- Kernel SSE2: 4 bloques por iteración ---
+// Cada registro contiene la misma palabra del estado para 4 bloques consecutivos.
+
+#define SSE_ROTL(x, n) _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+
+#define SSE_QR(a, b, c, d) \
+	a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = SSE_ROTL(d, 16); \
+	c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = SSE_ROTL(b, 12); \
+	a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = SSE_ROTL(d, 8);  \
+	c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = SSE_ROTL(b, 7)
+
+// Transpone 4 palabras x 4 bloques y aplica XOR sobre 16 bytes de cada bloque
+static inline void sseXor4(uint8_t* blk, __m128i a, __m128i b, __m128i c, __m128i d, std::size_t off) {
+	__m128i t0 = _mm_unpacklo_epi32(a, b), t1 = _mm_unpacklo_epi32(c, d);
+	__m128i t2 = _mm_unpackhi_epi32(a, b), t3 = _mm_unpackhi_epi32(c, d);
+	__m128i r[4] = {_mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+	                _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)};
+	for (int j = 0; j < 4; ++j) {
+		__m128i* p = reinterpret_cast<__m128i*>(blk + j*64 + off);
+		_mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), r[j]));
+	}
+}
+
+static std::size_t chachaXorSSE2(uint32_t state[16], uint8_t* data, std::size_t len) {
+	std::size_t done = 0;
+	while (len - done >= 256) {
+		__m128i s[16], x[16];
+		for (int i = 0; i < 16; ++i) s[i] = _mm_set1_epi32(static_cast<int>(state[i]));
+		// Contadores consecutivos (con acarreo hacia la palabra alta)
+		uint64_t c = static_cast<uint64_t>(state[13]) << 32 | state[12];
+		s[12] = _mm_set_epi32(static_cast<int>(c + 3), static_cast<int>(c + 2), static_cast<int>(c + 1), static_cast<int>(c));
+		s[13] = _mm_set_epi32(static_cast<int>((c + 3) >> 32), static_cast<int>((c + 2) >> 32),
+		                      static_cast<int>((c + 1) >> 32), static_cast<int>(c >> 32));
+		for (int i = 0; i < 16; ++i) x[i] = s[i];
+		for (int i = 0; i < 10; ++i) {
+			SSE_QR(x[0], x[4], x[8],  x[12]);
+			SSE_QR(x[1], x[5], x[9],  x[13]);
+			SSE_QR(x[2], x[6], x[10], x[14]);
+			SSE_QR(x[3], x[7], x[11], x[15]);
+			SSE_QR(x[0], x[5], x[10], x[15]);
+			SSE_QR(x[1], x[6], x[11], x[12]);
+			SSE_QR(x[2], x[7], x[8],  x[13]);
+			SSE_QR(x[3], x[4], x[9],  x[14]);
+		}
+		for (int i = 0; i < 16; ++i) x[i] = _mm_add_epi32(x[i], s[i]);
+		uint8_t* blk = data + done;
+		sseXor4(blk, x[0],  x[1],  x[2],  x[3],  0);
+		sseXor4(blk, x[4],  x[5],  x[6],  x[7],  16);
+		sseXor4(blk, x[8],  x[9],  x[10], x[11], 32);
+		sseXor4(blk, x[12], x[13], x[14], x[15], 48);
+		chachaIncrement(state, 4);
+		done += 256;
+	}
+	return done;
+}
+
+// --- Kernel AVX2: 8 bloques por iteración ---
+
+#define AVX_ROTL(x, n) _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+
+#define AVX_QR(a, b, c, d) \
+	a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot16); \
+	c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = AVX_ROTL(b, 12); \
+	a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot8); \
+	c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = AVX_ROTL(b, 7)
+
+// Transposición 4x4 dentro de cada carril de 128 bits
+__attribute__((target("avx2")))
+static inline void avxTranspose4(__m256i &a, __m256i &b, __m256i &c, __m256i &d) {
+	__m256i t0 = _mm256_unpacklo_epi32(a, b), t1 = _mm256_unpacklo_epi32(c, d);
+	__m256i t2 = _mm256_unpackhi_epi32(a, b), t3 = _mm256_unpackhi_epi32(c, d);
+	a = _mm256_unpacklo_epi64(t0, t1);
+	b = _mm256_unpackhi_epi64(t0, t1);
+	c = _mm256_unpacklo_epi64(t2, t3);
+	d = _mm256_unpackhi_epi64(t2, t3);
+}
+
+__attribute__((target("avx2")))
+static inline void avxXor32(uint8_t* p, __m256i ks) {
+	__m256i* q = reinterpret_cast<__m256i*>(p);
+	_mm256_storeu_si256(q, _mm256_xor_si256(_mm256_loadu_si256(q), ks));
+}
+
+__attribute__((target("avx2")))
+static std::size_t chachaXorAVX2(uint32_t state[16], uint8_t* data, std::size_t len) {
+	const __m256i rot16 = _mm256_set_epi8(13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2,
+	                                      13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2);
+	const __m256i rot8  = _mm256_set_epi8(14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3,
+	                                      14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3);
+	std::size_t done = 0;
+	while (len - done >= 512) {
+		__m256i s[16], x[16];
+		for (int i = 0; i < 16; ++i) s[i] = _mm256_set1_epi32(static_cast<int>(state[i]));
+		// Carril 0 -> bloques c..c+3, carril 1 -> bloques c+4..c+7
+		uint64_t c = static_cast<uint64_t>(state[13]) << 32 | state[12];
+		alignas(32) uint32_t lo[8], hi[8];
+		for (int k = 0; k < 8; ++k) {
+			lo[k] = static_cast<uint32_t>(c + k);
+			hi[k] = static_cast<uint32_t>((c + k) >> 32);
+		}
+		s[12] = _mm256_load_si256(reinterpret_cast<const __m256i*>(lo));
+		s[13] = _mm256_load_si256(reinterpret_cast<const __m256i*>(hi));
+		for (int i = 0; i < 16; ++i) x[i] = s[i];
+		for (int i = 0; i < 10; ++i) {
+			AVX_QR(x[0], x[4], x[8],  x[12]);
+			AVX_QR(x[1], x[5], x[9],  x[13]);
+			AVX_QR(x[2], x[6], x[10], x[14]);
+			AVX_QR(x[3], x[7], x[11], x[15]);
+			AVX_QR(x[0], x[5], x[10], x[15]);
+			AVX_QR(x[1], x[6], x[11], x[12]);
+			AVX_QR(x[2], x[7], x[8],  x[13]);
+			AVX_QR(x[3], x[4], x[9],  x[14]);
+		}
+		for (int i = 0; i < 16; ++i) x[i] = _mm256_add_epi32(x[i], s[i]);
+		for (int g = 0; g < 16; g += 4) avxTranspose4(x[g], x[g+1], x[g+2], x[g+3]);
+
+		// x[g+j]: carril bajo = palabras g..g+3 del bloque j, carril alto = del bloque j+4
+		uint8_t* blk = data + done;
+		for (int j = 0; j < 4; ++j) {
+			avxXor32(blk + j*64,          _mm256_permute2x128_si256(x[j], x[4 + j], 0x20));
+			avxXor32(blk + j*64 + 32,     _mm256_permute2x128_si256(x[8 + j], x[12 + j], 0x20));
+			avxXor32(blk + (j+4)*64,      _mm256_permute2x128_si256(x[j], x[4 + j], 0x31));
+			avxXor32(blk + (j+4)*64 + 32, _mm256_permute2x128_si256(x[8 + j], x[12 + j], 0x31));
+		}
+		chachaIncrement(state, 8);
+		done += 512;
+	}
+	return done;
+}
+
+#endif
+
+enum class ChaChaKernel { Scalar, SSE2, AVX2 };
+
+static ChaChaKernel chachaDetectKernel() {
+#ifdef CHACHA_HAVE_X86
+	static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+	return hasAvx2 ? ChaChaKernel::AVX2 : ChaChaKernel::SSE2;
+#else
+	return ChaChaKernel::Scalar;
+#endif
+}
+
+void chacha20Xor(const uint8_t key[32], const uint8_t nonce[8], uint64_t counter,
+                 uint8_t* data, std::size_t len) {
+	uint32_t state[16];
+	chachaInitState(state, key, nonce, counter);
+
+	std::size_t done = 0;
+#ifdef CHACHA_HAVE_X86
+	ChaChaKernel kernel = chachaDetectKernel();
+	if (kernel == ChaChaKernel::AVX2) done += chachaXorAVX2(state, data, len);
+	done += chachaXorSSE2(state, data + done, len - done);
+#endif
+	chachaXorScalar(state, data + done, len - done);
+}
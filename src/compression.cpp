@@ -1,295 +1,371 @@
 #include "compression.h"
 #include "fileManager.h"
-#include <unistd.h>
-#include <fcntl.h>
+#include "BufferPool.h"
+#include "StagedExecutor.h"
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include <cstdint>
-#include <queue>
+#include <cstring>
 #include <array>
+#include <algorithm>
+#include <new>
+
+// Los códecs son transformaciones incrementales (StreamTransform): aceptan la entrada
+// en trozos de cualquier tamaño y mantienen entre llamadas el estado necesario
+// (run actual, diccionario, bytes de un registro incompleto, etc.)
+//
+// Sus buffers salen del BufferPool del hilo y sus tablas (diccionarios LZW, nodos
+// Huffman) de la arena del pool, así que procesar un archivo no llama a malloc.
+
+// Tamaño del buffer de salida antes de enviarlo al sink (política de E/S)
+static size_t outputBufSize() {
+    return getIoPolicy().streamBufferSize;
+}
 
 // Compress usando Run-Length Encoding (RLE)
 // Formato: [count:4bytes][char:1byte] repetido
-void compressRLE(const std::string &inputPath, const std::string &outputPath) {
-
-    // Abrir archivos de entrada y salida
-    int inputFd = openFile(inputPath, O_RDONLY);
-    if (inputFd == -1) return;
-
-    int outputFd = openFile(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (outputFd == -1) {
-        closeFile(inputFd);
-        return;
-    }
+class RLECompressor : public StreamTransform {
+public:
+    RLECompressor() : outputBuffer(outputBufSize()) {}
 
-    // Buffers optimizados para I/O por bloques
-    constexpr size_t INPUT_BUF_SIZE = 4096;  // 4KB buffer de entrada
-    constexpr size_t OUTPUT_BUF_SIZE = 4096; // 4KB buffer de salida
-    std::vector<char> inputBuffer(INPUT_BUF_SIZE);
-    std::vector<char> outputBuffer;
-    outputBuffer.reserve(OUTPUT_BUF_SIZE);
+    bool update(const uint8_t* data, size_t len, ByteSink &sink) override {
+        for (size_t i = 0; i < len; ++i) {
+            uint8_t currentChar = data[i];
 
-    char previousChar = '\0';
-    int count = 0;
-    bool first = true;
-    ssize_t bytesRead;
-
-    // Procesar archivo por bloques
-    while ((bytesRead = readFile(inputFd, inputBuffer.data(), INPUT_BUF_SIZE)) > 0) {
-        for (ssize_t i = 0; i < bytesRead; ++i) {
-            char currentChar = inputBuffer[i];
-            
             if (!first && currentChar == previousChar) {
                 count++;
             } else {
-                if (!first) {
-                    // Escribir count (4 bytes) + carácter (1 byte) al buffer
-                    outputBuffer.insert(outputBuffer.end(), 
-                                      reinterpret_cast<char*>(&count),
-                                      reinterpret_cast<char*>(&count) + sizeof(int));
-                    outputBuffer.push_back(previousChar);
-                    
-                    // Flush buffer si está cerca del límite
-                    if (outputBuffer.size() >= OUTPUT_BUF_SIZE - 5) {
-                        writeFile(outputFd, outputBuffer.data(), outputBuffer.size());
-                        outputBuffer.clear();
-                    }
-                }
+                if (!first && !emitPair(sink)) return false;
                 previousChar = currentChar;
                 count = 1;
                 first = false;
             }
         }
+        return true;
     }
 
-    // Escribir el último par count+char
-    if (!first) {
-        outputBuffer.insert(outputBuffer.end(), 
-                          reinterpret_cast<char*>(&count),
-                          reinterpret_cast<char*>(&count) + sizeof(int));
-        outputBuffer.push_back(previousChar);
+    bool finish(ByteSink &sink) override {
+        // Escribir el último par count+char
+        if (!first && !emitPair(sink)) return false;
+        first = true;
+        return outputBuffer->empty() || sink.write(outputBuffer->data(), outputBuffer->size()) != -1;
     }
 
-    // Flush buffer final
-    if (!outputBuffer.empty()) {
-        writeFile(outputFd, outputBuffer.data(), outputBuffer.size());
-    }
+private:
+    const size_t flushSize = outputBufSize();
+    PooledBuffer outputBuffer;
+    uint8_t previousChar = 0;
+    int count = 0;
+    bool first = true;
 
-    closeFile(inputFd);
-    closeFile(outputFd);
-}
+    // Escribir count (4 bytes) + carácter (1 byte) al buffer; flush si está cerca del límite
+    bool emitPair(ByteSink &sink) {
+        outputBuffer->insert(outputBuffer->end(),
+                             reinterpret_cast<uint8_t*>(&count),
+                             reinterpret_cast<uint8_t*>(&count) + sizeof(int));
+        outputBuffer->push_back(previousChar);
+        if (outputBuffer->size() >= flushSize - 5) {
+            if (sink.write(outputBuffer->data(), outputBuffer->size()) == -1) return false;
+            outputBuffer->clear();
+        }
+        return true;
+    }
+};
 
 // Decompress usando Run-Length Encoding (RLE)
 // Formato esperado: [count:4bytes][char:1byte] repetido
-void decompressRLE(const std::string &inputPath, const std::string &outputPath) {
-
-    // Abrir archivos de entrada y salida
-    int inputFd = openFile(inputPath, O_RDONLY);
-    if (inputFd == -1) return;
-
-    int outputFd = openFile(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (outputFd == -1) {
-        closeFile(inputFd);
-        return;
-    }
-
-    // Buffer optimizado para escritura
-    constexpr size_t OUTPUT_BUF_SIZE = 4096; // 4KB buffer
-    std::vector<char> outputBuffer;
-    outputBuffer.reserve(OUTPUT_BUF_SIZE);
-
-    int count;
-    char ch;
-    
-    // Leer pares de [count][char] hasta el final del archivo
-    while (readFile(inputFd, &count, sizeof(int)) == sizeof(int)) {
-        if (readFile(inputFd, &ch, 1) == 1) {
-            // Escribir el carácter 'count' veces al buffer
-            for (int j = 0; j < count; j++) {
-                outputBuffer.push_back(ch);
-                
-                // Flush buffer si está lleno
-                if (outputBuffer.size() >= OUTPUT_BUF_SIZE) {
-                    writeFile(outputFd, outputBuffer.data(), outputBuffer.size());
-                    outputBuffer.clear();
-                }
+class RLEDecompressor : public StreamTransform {
+public:
+    RLEDecompressor() : outputBuffer(outputBufSize()) {}
+
+    bool update(const uint8_t* data, size_t len, ByteSink &sink) override {
+        size_t i = 0;
+        // Completar un par que quedó cortado entre dos trozos
+        while (pendingLen > 0 && pendingLen < PAIR_SIZE && i < len) {
+            pending[pendingLen++] = data[i++];
+        }
+        if (pendingLen == PAIR_SIZE) {
+            if (!expandPair(pending, sink)) return false;
+            pendingLen = 0;
+        }
+        // Pares completos directamente desde la entrada
+        for (; i + PAIR_SIZE <= len; i += PAIR_SIZE) {
+            if (!expandPair(data + i, sink)) return false;
+        }
+        // Guardar el resto (< 5 bytes) para el siguiente trozo
+        while (i < len) pending[pendingLen++] = data[i++];
+        return true;
+    }
+
+    bool finish(ByteSink &sink) override {
+        // Un par incompleto al final se ignora
+        pendingLen = 0;
+        return outputBuffer->empty() || sink.write(outputBuffer->data(), outputBuffer->size()) != -1;
+    }
+
+private:
+    const size_t flushSize = outputBufSize();
+    static constexpr size_t PAIR_SIZE = sizeof(int) + 1;
+    PooledBuffer outputBuffer;
+    uint8_t pending[PAIR_SIZE];
+    size_t pendingLen = 0;
+
+    // Escribir el carácter 'count' veces al buffer
+    bool expandPair(const uint8_t* pair, ByteSink &sink) {
+        int count;
+        std::memcpy(&count, pair, sizeof(int));
+        uint8_t ch = pair[sizeof(int)];
+        for (int j = 0; j < count; j++) {
+            outputBuffer->push_back(ch);
+
+            // Flush buffer si está lleno
+            if (outputBuffer->size() >= flushSize) {
+                if (sink.write(outputBuffer->data(), outputBuffer->size()) == -1) return false;
+                outputBuffer->clear();
             }
         }
+        return true;
     }
-
-    // Flush buffer final
-    if (!outputBuffer.empty()) {
-        writeFile(outputFd, outputBuffer.data(), outputBuffer.size());
-    }
-
-    closeFile(inputFd);
-    closeFile(outputFd);
-}
+};
 
 // Compress usando Lempel-Ziv-Welch (LZW)
 // Formato: secuencia de códigos de 16 bits (2 bytes cada uno)
-void compressLZW(const std::string &inputPath, const std::string &outputPath) {
-
-    // Abrir archivos de entrada y salida
-    int inputFd = openFile(inputPath, O_RDONLY);
-    if (inputFd == -1) return;
-
-    int outputFd = openFile(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (outputFd == -1) {
-        closeFile(inputFd);
-        return;
-    }
+//
+// Cada entrada del diccionario es (código de w, siguiente byte), así que se guarda
+// en una tabla hash de direccionamiento abierto tomada de la arena en lugar de
+// un mapa de strings. Los códigos de un solo carácter (0..255) son implícitos.
+class LZWCompressor : public StreamTransform {
+public:
+    LZWCompressor() : arena(BufferPool::current().arena()), outputCodes(outputBufSize()) {
+        allocateTable(INITIAL_TABLE_SIZE);
+    }
+
+    bool update(const uint8_t* data, size_t len, ByteSink &sink) override {
+        size_t i = 0;
+        if (!hasW && len > 0) {
+            w = data[0];
+            hasW = true;
+            i = 1;
+        }
+        for (; i < len; ++i) {
+            uint8_t c = data[i];
+            uint32_t key = (w << 8) | c;
+            int32_t wc = lookup(key);
 
-    // Diccionario optimizado con reserva de capacidad
-    std::unordered_map<std::string, int> dictionary;
-    dictionary.reserve(4096); // Pre-reservar espacio
-    for (int i = 0; i < 256; i++) {
-        dictionary[std::string(1, static_cast<char>(i))] = i;    
-    }
-
-    std::string w;
-    w.reserve(256); // Pre-reservar para reducir reasignaciones
-    int nextCode = 256;
-    std::vector<uint16_t> outputCodes;
-    outputCodes.reserve(8192); // Pre-reservar espacio
-
-    // Buffer de lectura optimizado
-    constexpr size_t INPUT_BUF_SIZE = 4096; // 4KB
-    std::vector<char> inputBuffer(INPUT_BUF_SIZE);
-    ssize_t bytesRead;
-
-    // Procesar archivo por bloques
-    while ((bytesRead = readFile(inputFd, inputBuffer.data(), INPUT_BUF_SIZE)) > 0) {
-        for (ssize_t i = 0; i < bytesRead; ++i) {
-            char c = inputBuffer[i];
-            std::string wc = w + c;
-            
-            if (dictionary.count(wc)) {
-                w = std::move(wc);
+            if (wc >= 0) {
+                w = static_cast<uint32_t>(wc);
             } else {
                 // Emitir código de w
-                if (!w.empty()) {
-                    outputCodes.push_back(static_cast<uint16_t>(dictionary[w]));
-                }
+                if (!emitCode(static_cast<uint16_t>(w), sink)) return false;
                 // Añadir nueva entrada si no se alcanzó el límite de 16 bits
-                if (nextCode <= 0xFFFF) {
-                    dictionary[wc] = nextCode++;
-                }
-                w = std::string(1, c);
+                if (nextCode <= 0xFFFF) insert(key, nextCode++);
+                w = c;
             }
         }
-    }
-    
-    // Emitir último código
-    if (!w.empty()) {
-        outputCodes.push_back(static_cast<uint16_t>(dictionary[w]));
+        return true;
     }
 
-    // Escribir códigos en bloques para mejor rendimiento
-    if (!outputCodes.empty()) {
-        writeFile(outputFd, outputCodes.data(), outputCodes.size() * sizeof(uint16_t));
+    bool finish(ByteSink &sink) override {
+        // Emitir último código
+        if (hasW && !emitCode(static_cast<uint16_t>(w), sink)) return false;
+        hasW = false;
+        return outputCodes->empty() || sink.write(outputCodes->data(), outputCodes->size()) != -1;
     }
 
-    close(inputFd);
-    close(outputFd);
-}
+private:
+    const size_t flushSize = outputBufSize();
+    // La tabla crece al superar la mitad de ocupación: como máximo ~65280 entradas en 131072 posiciones
+    static constexpr size_t INITIAL_TABLE_SIZE = 4096;
 
-// Descompress usando Lempel-Ziv-Welch LZW
-// Formato esperado: secuencia de códigos de 16 bits (2 bytes cada uno)
-void decompressLZW(const std::string &inputPath, const std::string &outputPath) {
-    // Abrir archivos de entrada y salida
-    int inputFd = openFile(inputPath, O_RDONLY);
-    if (inputFd == -1) return;
+    // key = (código de w << 8 | byte) + 1; 0 marca una posición libre
+    struct Slot {
+        uint32_t key;
+        uint32_t code;
+    };
 
-    int outputFd = openFile(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (outputFd == -1) {
-        closeFile(inputFd);
-        return;
+    Arena &arena;
+    PooledBuffer outputCodes;
+    Slot* table = nullptr;
+    size_t tableMask = 0;
+    size_t entries = 0;
+    uint32_t w = 0;
+    bool hasW = false;
+    uint32_t nextCode = 256;
+
+    static size_t slotFor(uint32_t key) {
+        uint32_t h = key * 2654435761u;
+        return h ^ (h >> 16);
     }
 
-    // Inicializar diccionario con 0..255 y pre-reservar
-    std::vector<std::string> dictionary;
-    dictionary.reserve(65536);
-    for (int i = 0; i < 256; ++i) {
-        dictionary.push_back(std::string(1, static_cast<char>(i)));
-    }
-    int nextCode = 256;
-
-    // Buffer de salida optimizado
-    constexpr size_t OUTPUT_BUF_SIZE = 4096; // 4KB
-    std::vector<char> outputBuffer;
-    outputBuffer.reserve(OUTPUT_BUF_SIZE);
-
-    // Leer códigos en bloques para mejor rendimiento
-    constexpr size_t CODE_BUF_SIZE = 8192; // Leer 8K códigos a la vez
-    std::vector<uint16_t> codeBuffer(CODE_BUF_SIZE);
-    
-    // Leer el primer código
-    if (readFile(inputFd, &codeBuffer[0], sizeof(uint16_t)) != sizeof(uint16_t)) {
-        closeFile(inputFd);
-        closeFile(outputFd);
-        return;
+    void allocateTable(size_t size) {
+        table = arena.allocateArray<Slot>(size);
+        std::memset(table, 0, size * sizeof(Slot));
+        tableMask = size - 1;
     }
 
-    uint16_t code = codeBuffer[0];
-    if (code >= dictionary.size()) {
-        closeFile(inputFd);
-        closeFile(outputFd);
-        return;
+    int32_t lookup(uint32_t key) const {
+        uint32_t stored = key + 1;
+        for (size_t i = slotFor(key) & tableMask; ; i = (i + 1) & tableMask) {
+            if (table[i].key == stored) return static_cast<int32_t>(table[i].code);
+            if (table[i].key == 0) return -1;
+        }
     }
 
-    std::string w = dictionary[code];
-    // Escribir w al buffer
-    outputBuffer.insert(outputBuffer.end(), w.begin(), w.end());
-
-    // Procesar códigos restantes por bloques
-    ssize_t bytesRead;
-    while ((bytesRead = readFile(inputFd, codeBuffer.data(), CODE_BUF_SIZE * sizeof(uint16_t))) > 0) {
-        size_t codesRead = bytesRead / sizeof(uint16_t);
-        
-        for (size_t i = 0; i < codesRead; ++i) {
-            uint16_t k = codeBuffer[i];
-            std::string entry;
-
-            if (k < dictionary.size()) {
-                entry = dictionary[k];
-            } else if (k == nextCode) {
-                // Caso especial: entry = w + first char of w
-                if (!w.empty()) entry = w + w[0];
-                else entry = std::string();
-            } else {
-                // Código inválido: abortar lectura
-                break;
-            }
+    void place(uint32_t stored, uint32_t code) {
+        size_t i = slotFor(stored - 1) & tableMask;
+        while (table[i].key != 0) i = (i + 1) & tableMask;
+        table[i].key = stored;
+        table[i].code = code;
+    }
 
-            // Escribir entry al buffer
-            outputBuffer.insert(outputBuffer.end(), entry.begin(), entry.end());
-            
-            // Flush si el buffer está cerca del límite
-            if (outputBuffer.size() >= OUTPUT_BUF_SIZE - 256) {
-                writeFile(outputFd, outputBuffer.data(), outputBuffer.size());
-                outputBuffer.clear();
+    void insert(uint32_t key, uint32_t code) {
+        if ((entries + 1) * 2 > tableMask + 1) {
+            // Duplicar la tabla; la anterior queda en la arena hasta el fin de la tarea
+            Slot* old = table;
+            size_t oldSize = tableMask + 1;
+            allocateTable(oldSize * 2);
+            for (size_t i = 0; i < oldSize; ++i) {
+                if (old[i].key != 0) place(old[i].key, old[i].code);
             }
+        }
+        place(key + 1, code);
+        ++entries;
+    }
 
-            // Agregar nueva entrada al diccionario
-            if (nextCode <= 0xFFFF && !entry.empty()) {
-                dictionary.push_back(w + entry[0]);
-                ++nextCode;
-            }
+    // Escribir códigos en bloques para mejor rendimiento
+    bool emitCode(uint16_t code, ByteSink &sink) {
+        outputCodes->insert(outputCodes->end(),
+                            reinterpret_cast<uint8_t*>(&code),
+                            reinterpret_cast<uint8_t*>(&code) + sizeof(code));
+        if (outputCodes->size() >= flushSize) {
+            if (sink.write(outputCodes->data(), outputCodes->size()) == -1) return false;
+            outputCodes->clear();
+        }
+        return true;
+    }
+};
 
-            w = std::move(entry);
+// Descompress usando Lempel-Ziv-Welch LZW
+// Formato esperado: secuencia de códigos de 16 bits (2 bytes cada uno)
+//
+// Cada código guarda (código prefijo, último byte, primer byte, longitud) en arreglos
+// de la arena; una entrada se reconstruye recorriendo los prefijos hacia atrás
+// directamente en el buffer de salida.
+class LZWDecompressor : public StreamTransform {
+public:
+    LZWDecompressor() : outputBuffer(outputBufSize()) {
+        Arena &arena = BufferPool::current().arena();
+        prefix = arena.allocateArray<uint16_t>(DICT_SIZE);
+        suffix = arena.allocateArray<uint8_t>(DICT_SIZE);
+        firstByte = arena.allocateArray<uint8_t>(DICT_SIZE);
+        length = arena.allocateArray<uint32_t>(DICT_SIZE);
+        // Inicializar diccionario con 0..255
+        for (uint32_t i = 0; i < 256; ++i) {
+            prefix[i] = 0;
+            suffix[i] = static_cast<uint8_t>(i);
+            firstByte[i] = static_cast<uint8_t>(i);
+            length[i] = 1;
         }
     }
 
-    // Flush buffer final
-    if (!outputBuffer.empty()) {
-        writeFile(outputFd, outputBuffer.data(), outputBuffer.size());
+    bool update(const uint8_t* data, size_t len, ByteSink &sink) override {
+        size_t i = 0;
+        // Completar un código partido entre dos trozos
+        if (hasPendingByte && len > 0) {
+            uint8_t bytes[2] = {pendingByte, data[0]};
+            uint16_t k;
+            std::memcpy(&k, bytes, sizeof(k));
+            if (!decodeCode(k, sink)) return false;
+            hasPendingByte = false;
+            i = 1;
+        }
+        for (; i + sizeof(uint16_t) <= len; i += sizeof(uint16_t)) {
+            uint16_t k;
+            std::memcpy(&k, data + i, sizeof(k));
+            if (!decodeCode(k, sink)) return false;
+        }
+        if (i < len) {
+            pendingByte = data[i];
+            hasPendingByte = true;
+        }
+        return true;
+    }
+
+    bool finish(ByteSink &sink) override {
+        // Un byte suelto al final se ignora
+        hasPendingByte = false;
+        return outputBuffer->empty() || sink.write(outputBuffer->data(), outputBuffer->size()) != -1;
+    }
+
+private:
+    const size_t flushSize = outputBufSize();
+    static constexpr size_t DICT_SIZE = 65536;
+    uint16_t* prefix;
+    uint8_t* suffix;
+    uint8_t* firstByte;
+    uint32_t* length;
+    uint32_t nextCode = 256;
+    uint16_t w = 0;
+    bool started = false;
+    PooledBuffer outputBuffer;
+    uint8_t pendingByte = 0;
+    bool hasPendingByte = false;
+
+    // Agregar w + c como código nextCode
+    void addEntry(uint8_t c) {
+        prefix[nextCode] = w;
+        suffix[nextCode] = c;
+        firstByte[nextCode] = firstByte[w];
+        length[nextCode] = length[w] + 1;
+        ++nextCode;
+    }
+
+    // Escribir la cadena del código k al final del buffer
+    void emitEntry(uint16_t k) {
+        size_t n = length[k];
+        size_t pos = outputBuffer->size();
+        outputBuffer->resize(pos + n);
+        uint8_t* out = outputBuffer->data() + pos;
+        uint32_t code = k;
+        for (size_t j = n; j-- > 0; ) {
+            out[j] = suffix[code];
+            code = prefix[code];
+        }
     }
 
-    closeFile(inputFd);
-    closeFile(outputFd);
-}
+    bool decodeCode(uint16_t k, ByteSink &sink) {
+        if (!started) {
+            // El primer código debe ser un carácter literal
+            if (k >= nextCode) return false;
+            started = true;
+            w = k;
+            emitEntry(k);
+            return true;
+        }
+
+        if (k < nextCode) {
+            emitEntry(k);
+            // Agregar nueva entrada al diccionario: w + primer carácter de entry
+            if (nextCode <= 0xFFFF) addEntry(firstByte[k]);
+        } else if (k == nextCode) {
+            // Caso especial: entry = w + first char of w (es la entrada que se agrega)
+            addEntry(firstByte[w]);
+            emitEntry(k);
+        } else {
+            // Código inválido
+            return false;
+        }
+
+        // Flush si el buffer está cerca del límite
+        if (outputBuffer->size() >= flushSize - 256) {
+            if (sink.write(outputBuffer->data(), outputBuffer->size()) == -1) return false;
+            outputBuffer->clear();
+        }
+
+        w = k;
+        return true;
+    }
+};
 
 // Compress usando Huffman
 // Formato:[Header][Payload Comprimido]
@@ -311,247 +387,468 @@ struct NodeCmp {
     }
 };
 
-// Liberar memoria del árbol Huffman
-static void freeTree(HuffNode* node) {
-    if (!node) return;
-    freeTree(node->left);
-    freeTree(node->right);
-    delete node;
+// Un árbol de 256 hojas tiene como máximo 511 nodos
+static constexpr size_t HUFF_MAX_NODES = 511;
+
+// Construir el árbol a partir de las frecuencias (mismo orden en compresor y descompresor).
+// Los nodos se crean en 'nodes' (HUFF_MAX_NODES posiciones) y el heap vive en la pila,
+// con el mismo orden que std::priority_queue.
+static HuffNode* buildTree(const std::array<uint64_t,256> &freq, HuffNode* nodes) {
+    HuffNode* heap[256];
+    size_t heapSize = 0;
+    size_t used = 0;
+    NodeCmp cmp;
+    for (int i = 0; i < 256; ++i) {
+        if (freq[i] > 0) {
+            heap[heapSize++] = new (&nodes[used++]) HuffNode(freq[i], static_cast<unsigned char>(i));
+            std::push_heap(heap, heap + heapSize, cmp);
+        }
+    }
+    if (heapSize == 0) return nullptr;
+    while (heapSize > 1) {
+        std::pop_heap(heap, heap + heapSize, cmp);
+        HuffNode* a = heap[--heapSize];
+        std::pop_heap(heap, heap + heapSize, cmp);
+        HuffNode* b = heap[--heapSize];
+        heap[heapSize++] = new (&nodes[used++]) HuffNode(a->freq + b->freq, a, b);
+        std::push_heap(heap, heap + heapSize, cmp);
+    }
+    return heap[0];
 }
 
-// Construir códigos recursivamente
-static void buildCodes(HuffNode* node, const std::string &prefix, std::array<std::string,256> &codes) {
+// Código de un símbolo: los 'length' bits menos significativos de 'bits', del msb al lsb
+struct HuffCode {
+    uint64_t bits;
+    uint32_t length;
+};
+
+// Construir códigos recursivamente. Con bloques de hasta HUFFMAN_BLOCK_SIZE bytes la
+// profundidad del árbol no pasa de ~34, así que el código cabe en 64 bits.
+static void buildCodes(HuffNode* node, uint64_t bits, uint32_t depth, std::array<HuffCode,256> &codes) {
     if (!node) return;
     if (!node->left && !node->right) {
         // hoja
-        codes[node->ch] = (prefix.empty() ? "0" : prefix); // caso único símbolo
+        codes[node->ch] = (depth == 0) ? HuffCode{0, 1} : HuffCode{bits, depth}; // caso único símbolo: "0"
         return;
     }
-    if (node->left) buildCodes(node->left, prefix + '0', codes);
-    if (node->right) buildCodes(node->right, prefix + '1', codes);
+    if (node->left) buildCodes(node->left, bits << 1, depth + 1, codes);
+    if (node->right) buildCodes(node->right, (bits << 1) | 1, depth + 1, codes);
 }
 
-void compressHuffman(const std::string &inputPath, const std::string &outputPath) {
-    int inputFd = openFile(inputPath, O_RDONLY);
-    if (inputFd == -1) return;
-    int outputFd = openFile(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (outputFd == -1) { closeFile(inputFd); return; }
-
-    // Leer archivo con buffer optimizado
-    std::vector<unsigned char> data;
-    constexpr size_t BUF_SZ = 4096; // 4KB buffer
-    std::vector<char> buf(BUF_SZ);
-    ssize_t r;
-    
-    // Pre-estimar tamaño para reducir reasignaciones
-    off_t fileSize = lseek(inputFd, 0, SEEK_END);
-    if (fileSize > 0) {
-        lseek(inputFd, 0, SEEK_SET);
-        data.reserve(fileSize);
-    }
-    
-    while ((r = readFile(inputFd, buf.data(), BUF_SZ)) > 0) {
-        data.insert(data.end(), buf.data(), buf.data() + r);
-    }
-
-    uint64_t origSize = data.size();
+// Cada bloque de entrada se codifica como una trama independiente [Header][Payload].
+// Así la compresión es de una sola pasada con memoria acotada (stdin, pipes);
+// un archivo de hasta HUFFMAN_BLOCK_SIZE bytes produce una sola trama, igual que antes.
+static constexpr size_t HUFFMAN_BLOCK_SIZE = 8 * 1024 * 1024;
+
+// Codifica 'size' bytes como una trama [Header][Payload]. 'nodes' tiene espacio para
+// HUFF_MAX_NODES nodos y 'bitBuffer' acumula el bitstream antes de escribirlo.
+static bool encodeHuffmanFrame(const uint8_t* data, size_t size, HuffNode* nodes, ByteBuffer &bitBuffer, ByteSink &sink) {
+    const size_t flushSize = outputBufSize();
+    uint64_t origSize = size;
     if (origSize == 0) {
         // escribir cabecera vacía: tamaño 0 y sin símbolos
         uint64_t z = 0;
         uint16_t zerosyms = 0;
-        writeFile(outputFd, &z, sizeof(z));
-        writeFile(outputFd, &zerosyms, sizeof(zerosyms));
-        closeFile(inputFd);
-        closeFile(outputFd);
-        return;
+        return sink.write(&z, sizeof(z)) != -1 &&
+               sink.write(&zerosyms, sizeof(zerosyms)) != -1;
     }
 
     // Calcular frecuencias
     std::array<uint64_t,256> freq{};
-    for (unsigned char c : data) freq[c]++;
-
-    // construir cola de prioridad
-    std::priority_queue<HuffNode*, std::vector<HuffNode*>, NodeCmp> pq;
-    for (int i = 0; i < 256; ++i) {
-        if (freq[i] > 0) {
-            pq.push(new HuffNode(freq[i], static_cast<unsigned char>(i)));
-        }
-    }
+    for (size_t i = 0; i < size; ++i) freq[data[i]]++;
 
     // construir árbol
-    if (pq.empty()) {
-        closeFile(inputFd);
-        closeFile(outputFd);
-        return;
-    }
-    while (pq.size() > 1) {
-        HuffNode* a = pq.top(); pq.pop();
-        HuffNode* b = pq.top(); pq.pop();
-        HuffNode* parent = new HuffNode(a->freq + b->freq, a, b);
-        pq.push(parent);
-    }
-    HuffNode* root = pq.top();
+    HuffNode* root = buildTree(freq, nodes);
+    if (!root) return false;
 
     // generar códigos
-    std::array<std::string,256> codes;
-    for (auto &s : codes) s.clear();
-    buildCodes(root, "", codes);
+    std::array<HuffCode,256> codes{};
+    buildCodes(root, 0, 0, codes);
 
     // Escribir cabecera
     uint64_t origSizeLE = origSize;
     uint16_t uniqueSymbols = 0;
     for (int i = 0; i < 256; ++i) if (freq[i] > 0) ++uniqueSymbols;
 
-    writeFile(outputFd, &origSizeLE, sizeof(origSizeLE));
-    writeFile(outputFd, &uniqueSymbols, sizeof(uniqueSymbols));
+    // La cabecera se arma en memoria y se escribe de una vez
+    uint8_t header[sizeof(uint64_t) + sizeof(uint16_t) + 256 * (1 + sizeof(uint64_t))];
+    size_t headerLen = 0;
+    std::memcpy(header + headerLen, &origSizeLE, sizeof(origSizeLE));
+    headerLen += sizeof(origSizeLE);
+    std::memcpy(header + headerLen, &uniqueSymbols, sizeof(uniqueSymbols));
+    headerLen += sizeof(uniqueSymbols);
     for (int i = 0; i < 256; ++i) {
         if (freq[i] > 0) {
-            uint8_t ch = static_cast<uint8_t>(i);
             uint64_t f = freq[i];
-            writeFile(outputFd, &ch, sizeof(ch));
-            writeFile(outputFd, &f, sizeof(f));
+            header[headerLen++] = static_cast<uint8_t>(i);
+            std::memcpy(header + headerLen, &f, sizeof(f));
+            headerLen += sizeof(f);
         }
     }
+    if (sink.write(header, headerLen) == -1) return false;
 
-    // Optimización: Escribir bitstream usando buffer
-    std::vector<unsigned char> bitBuffer;
-    bitBuffer.reserve(data.size() / 2); // Estimación conservadora
-    
-    unsigned char outByte = 0;
-    int bitCount = 0;
-    
-    for (unsigned char c : data) {
-        const std::string &code = codes[c];
-        for (char bit : code) {
-            outByte = (outByte << 1) | (bit == '1' ? 1 : 0);
-            ++bitCount;
-            if (bitCount == 8) {
-                bitBuffer.push_back(outByte);
-                outByte = 0;
-                bitCount = 0;
-                
-                // Flush buffer periódicamente
-                if (bitBuffer.size() >= BUF_SZ) {
-                    writeFile(outputFd, bitBuffer.data(), bitBuffer.size());
-                    bitBuffer.clear();
-                }
-            }
+    // Bitstream: los códigos se acumulan en un registro de 64 bits y salen de a bytes
+    bitBuffer.clear();
+    uint64_t acc = 0;
+    uint32_t bitCount = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        const HuffCode &code = codes[data[i]];
+        acc = (acc << code.length) | code.bits;
+        bitCount += code.length;
+        while (bitCount >= 8) {
+            bitCount -= 8;
+            bitBuffer.push_back(static_cast<uint8_t>(acc >> bitCount));
+        }
+
+        // Flush buffer periódicamente
+        if (bitBuffer.size() >= flushSize) {
+            if (sink.write(bitBuffer.data(), bitBuffer.size()) == -1) return false;
+            bitBuffer.clear();
         }
     }
-    
+
     // padding: rellenar con ceros a la derecha en el último byte si es necesario
     if (bitCount > 0) {
-        outByte <<= (8 - bitCount);
-        bitBuffer.push_back(outByte);
+        bitBuffer.push_back(static_cast<uint8_t>(acc << (8 - bitCount)));
     }
-    
+
     // Flush final
-    if (!bitBuffer.empty()) {
-        writeFile(outputFd, bitBuffer.data(), bitBuffer.size());
+    return bitBuffer.empty() || sink.write(bitBuffer.data(), bitBuffer.size()) != -1;
+}
+
+class HuffmanCompressor : public StreamTransform {
+public:
+    HuffmanCompressor()
+        : input(HUFFMAN_BLOCK_SIZE), bitBuffer(outputBufSize()),
+          nodes(BufferPool::current().arena().allocateArray<HuffNode>(HUFF_MAX_NODES)) {}
+
+    bool update(const uint8_t* data, size_t len, ByteSink &sink) override {
+        while (len > 0) {
+            size_t take = std::min(len, HUFFMAN_BLOCK_SIZE - input->size());
+            input->insert(input->end(), data, data + take);
+            data += take;
+            len -= take;
+            if (input->size() == HUFFMAN_BLOCK_SIZE) {
+                if (!encodeHuffmanFrame(input->data(), input->size(), nodes, *bitBuffer, sink)) return false;
+                input->clear();
+                ++frames;
+            }
+        }
+        return true;
     }
 
-    freeTree(root);
-    closeFile(inputFd);
-    closeFile(outputFd);
-}
+    bool finish(ByteSink &sink) override {
+        // Un bloque parcial (o la trama vacía si no hubo entrada) cierra el flujo
+        if (input->empty() && frames > 0) return true;
+        bool ok = encodeHuffmanFrame(input->data(), input->size(), nodes, *bitBuffer, sink);
+        input->clear();
+        return ok;
+    }
+
+private:
+    PooledBuffer input;
+    PooledBuffer bitBuffer;
+    HuffNode* nodes;
+    size_t frames = 0;
+};
 
 // Decompress usando Huffman
-// Formato esperado: [Header][Payload Descomprimido]
-void decompressHuffman(const std::string &inputPath, const std::string &outputPath) {
-    int inputFd = openFile(inputPath, O_RDONLY);
-    if (inputFd == -1) return;
-    int outputFd = openFile(outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    if (outputFd == -1) { closeFile(inputFd); return; }
+// Formato esperado: una o más tramas [Header][Payload Comprimido]
+// La cabecera se acumula hasta estar completa; luego el bitstream se decodifica
+// a medida que llega, hasta producir origSize bytes. El resto del último byte es
+// relleno y lo que sigue es la cabecera de la siguiente trama.
+class HuffmanDecompressor : public StreamTransform {
+public:
+    HuffmanDecompressor()
+        : outbuf(outputBufSize()),
+          nodes(BufferPool::current().arena().allocateArray<HuffNode>(HUFF_MAX_NODES)) {}
+
+    bool update(const uint8_t* data, size_t len, ByteSink &sink) override {
+        size_t i = 0;
+        while (i < len) {
+            if (!headerDone) {
+                while (i < len && !headerDone) {
+                    header[headerLen++] = data[i++];
+                    if (!parseHeader()) return false;
+                }
+                if (!headerDone) return true;
+                if (!root) {
+                    endFrame(); // trama vacía: no hay bitstream
+                    continue;
+                }
+            }
 
-    // leer cabecera
-    uint64_t origSize = 0;
-    if (readFile(inputFd, &origSize, sizeof(origSize)) != (ssize_t)sizeof(origSize)) {
-        closeFile(inputFd);
-        closeFile(outputFd);
-        return;
+            // Decodificar bit a bit, de msb a lsb
+            for (; i < len && written < origSize; ++i) {
+                unsigned char b = data[i];
+                for (int bit = 7; bit >= 0 && written < origSize; --bit) {
+                    int v = (b >> bit) & 1;
+                    // Con un solo símbolo la raíz es hoja y cada bit es un símbolo
+                    if (node->left || node->right) node = (v == 0) ? node->left : node->right;
+
+                    if (!node->left && !node->right) {
+                        // Nodo hoja encontrado
+                        outbuf->push_back(node->ch);
+                        ++written;
+                        node = root;
+
+                        // Flush buffer cuando esté lleno
+                        if (outbuf->size() >= flushSize) {
+                            if (sink.write(outbuf->data(), outbuf->size()) == -1) return false;
+                            outbuf->clear();
+                        }
+                    }
+                }
+            }
+            if (written == origSize) endFrame();
+        }
+        return true;
+    }
+
+    bool finish(ByteSink &sink) override {
+        // Sin tramas completas o con una trama a medias el archivo está truncado o es inválido
+        if (frames == 0 || headerDone || headerLen > 0) return false;
+        return outbuf->empty() || sink.write(outbuf->data(), outbuf->size()) != -1;
     }
+
+private:
+    const size_t flushSize = outputBufSize();
+    static constexpr size_t FIXED_HEADER = sizeof(uint64_t) + sizeof(uint16_t);
+    static constexpr size_t SYMBOL_ENTRY = sizeof(uint8_t) + sizeof(uint64_t);
+
+    uint8_t header[FIXED_HEADER + 256 * SYMBOL_ENTRY];
+    size_t headerLen = 0;
+    bool headerDone = false;
+    uint64_t origSize = 0;
     uint16_t uniqueSymbols = 0;
-    if (readFile(inputFd, &uniqueSymbols, sizeof(uniqueSymbols)) != (ssize_t)sizeof(uniqueSymbols)) {
-        closeFile(inputFd);
-        closeFile(outputFd);
-        return;
+    HuffNode* root = nullptr;
+    HuffNode* node = nullptr;
+    uint64_t written = 0;
+    size_t frames = 0;
+    PooledBuffer outbuf;
+    HuffNode* nodes;
+
+    // Deja el estado listo para la cabecera de la siguiente trama (los nodos se reutilizan)
+    void endFrame() {
+        root = node = nullptr;
+        headerLen = 0;
+        headerDone = false;
+        origSize = 0;
+        uniqueSymbols = 0;
+        written = 0;
+        ++frames;
+    }
+
+    // Retorna false solo si la cabecera es inválida
+    bool parseHeader() {
+        if (headerLen == FIXED_HEADER) {
+            std::memcpy(&origSize, header, sizeof(origSize));
+            std::memcpy(&uniqueSymbols, header + sizeof(origSize), sizeof(uniqueSymbols));
+            // Solo la trama vacía (tamaño 0, sin símbolos) omite la tabla
+            if ((origSize == 0) != (uniqueSymbols == 0) || uniqueSymbols > 256) return false;
+            if (origSize == 0) headerDone = true;
+            return true;
+        }
+        if (headerLen < FIXED_HEADER || headerLen < FIXED_HEADER + uniqueSymbols * SYMBOL_ENTRY) {
+            return true;
+        }
+
+        // reconstruir tabla de frecuencias
+        std::array<uint64_t,256> freq{};
+        for (size_t s = 0; s < uniqueSymbols; ++s) {
+            const unsigned char* entry = header + FIXED_HEADER + s * SYMBOL_ENTRY;
+            uint64_t f;
+            std::memcpy(&f, entry + 1, sizeof(f));
+            freq[entry[0]] = f;
+        }
+
+        // reconstruir árbol Huffman
+        root = buildTree(freq, nodes);
+        if (!root) return false;
+        node = root;
+        headerDone = true;
+        headerLen = 0;
+        return true;
     }
-    if (origSize == 0 || uniqueSymbols == 0) {
-        closeFile(inputFd);
-        closeFile(outputFd);
-        return;
+};
+
+// --- Fábricas ---
+
+std::unique_ptr<StreamTransform> makeRLECompressor() { return std::unique_ptr<StreamTransform>(new RLECompressor()); }
+std::unique_ptr<StreamTransform> makeRLEDecompressor() { return std::unique_ptr<StreamTransform>(new RLEDecompressor()); }
+std::unique_ptr<StreamTransform> makeLZWCompressor() { return std::unique_ptr<StreamTransform>(new LZWCompressor()); }
+std::unique_ptr<StreamTransform> makeLZWDecompressor() { return std::unique_ptr<StreamTransform>(new LZWDecompressor()); }
+std::unique_ptr<StreamTransform> makeHuffmanCompressor() { return std::unique_ptr<StreamTransform>(new HuffmanCompressor()); }
+std::unique_ptr<StreamTransform> makeHuffmanDecompressor() { return std::unique_ptr<StreamTransform>(new HuffmanDecompressor()); }
+
+// --- Variantes sobre ByteSource/ByteSink ---
+// Las tablas que cada transformación toma de la arena se liberan al cerrar su scope
+
+bool compressRLEStream(ByteSource &source, ByteSink &sink) {
+    BufferPoolScope memory(BufferPool::current());
+    return runTransform(source, *makeRLECompressor(), sink);
+}
+
+bool decompressRLEStream(ByteSource &source, ByteSink &sink) {
+    BufferPoolScope memory(BufferPool::current());
+    return runTransform(source, *makeRLEDecompressor(), sink);
+}
+
+bool compressLZWStream(ByteSource &source, ByteSink &sink) {
+    BufferPoolScope memory(BufferPool::current());
+    return runTransform(source, *makeLZWCompressor(), sink);
+}
+
+bool decompressLZWStream(ByteSource &source, ByteSink &sink) {
+    BufferPoolScope memory(BufferPool::current());
+    return runTransform(source, *makeLZWDecompressor(), sink);
+}
+
+// Destino que agrega lo escrito a un ByteBuffer (la salida de un bloque del ejecutor)
+class ByteBufferSink : public ByteSink {
+public:
+    explicit ByteBufferSink(ByteBuffer &out) : out_(out) {}
+
+    ssize_t write(const void* buffer, size_t size) override {
+        const uint8_t* p = static_cast<const uint8_t*>(buffer);
+        out_.insert(out_.end(), p, p + size);
+        return static_cast<ssize_t>(size);
     }
 
-    // reconstruir tabla de frecuencias
-    std::array<uint64_t,256> freq{};
-    for (int i = 0; i < uniqueSymbols; ++i) {
-        uint8_t ch;
-        uint64_t f;
-        if (readFile(inputFd, &ch, sizeof(ch)) != (ssize_t)sizeof(ch) ||
-            readFile(inputFd, &f, sizeof(f)) != (ssize_t)sizeof(f)) {
-            closeFile(inputFd);
-            closeFile(outputFd);
-            return;
+private:
+    ByteBuffer &out_;
+};
+
+long long huffmanDecodedSize(int fd) {
+    long long fileSize = getFileSize(fd);
+    if (fileSize < 0) return -1;
+    BufferPoolScope memory(BufferPool::current());
+    HuffNode* nodes = BufferPool::current().arena().allocateArray<HuffNode>(HUFF_MAX_NODES);
+
+    // Cada trama: [origSize:8][símbolos:2][símbolo:1 frecuencia:8]... y el bitstream, cuyo
+    // largo sale de las frecuencias y las longitudes de código (mismo árbol que el codificador)
+    long long total = 0;
+    long long offset = 0;
+    while (offset < fileSize) {
+        uint8_t fixed[sizeof(uint64_t) + sizeof(uint16_t)];
+        if (readFileAt(fd, fixed, sizeof(fixed), offset) != static_cast<ssize_t>(sizeof(fixed))) return -1;
+        uint64_t origSize;
+        uint16_t symbols;
+        std::memcpy(&origSize, fixed, sizeof(origSize));
+        std::memcpy(&symbols, fixed + sizeof(origSize), sizeof(symbols));
+        if (symbols > 256) return -1;
+        offset += sizeof(fixed);
+
+        uint8_t table[256 * (1 + sizeof(uint64_t))];
+        size_t tableLen = symbols * (1 + sizeof(uint64_t));
+        if (readFileAt(fd, table, tableLen, offset) != static_cast<ssize_t>(tableLen)) return -1;
+        offset += static_cast<long long>(tableLen);
+        if (origSize == 0) continue;
+
+        std::array<uint64_t,256> freq{};
+        for (size_t k = 0; k < symbols; ++k) {
+            uint64_t f;
+            std::memcpy(&f, table + k * (1 + sizeof(uint64_t)) + 1, sizeof(f));
+            freq[table[k * (1 + sizeof(uint64_t))]] = f;
         }
-        freq[ch] = f;
-    }
+        HuffNode* root = buildTree(freq, nodes);
+        if (!root) return -1;
+        std::array<HuffCode,256> codes{};
+        buildCodes(root, 0, 0, codes);
+        uint64_t bits = 0;
+        for (int c = 0; c < 256; ++c) bits += freq[c] * codes[c].length;
+        offset += static_cast<long long>((bits + 7) / 8);
+        total += static_cast<long long>(origSize);
+    }
+    return offset == fileSize ? total : -1;
+}
 
-    // reconstruir árbol Huffman
-    std::priority_queue<HuffNode*, std::vector<HuffNode*>, NodeCmp> pq;
-    for (int i = 0; i < 256; ++i) {
-        if (freq[i] > 0) pq.push(new HuffNode(freq[i], static_cast<unsigned char>(i)));
-    }
-    if (pq.empty()) { closeFile(inputFd); closeFile(outputFd); return; }
-    while (pq.size() > 1) {
-        HuffNode* a = pq.top(); pq.pop();
-        HuffNode* b = pq.top(); pq.pop();
-        HuffNode* parent = new HuffNode(a->freq + b->freq, a, b);
-        pq.push(parent);
-    }
-    HuffNode* root = pq.top();
-
-    // Buffer optimizado para decodificación y escritura
-    constexpr size_t INPUT_BUF_SZ = 4096;  // 4KB input buffer
-    constexpr size_t OUTPUT_BUF_SZ = 4096; // 4KB output buffer
-    std::vector<unsigned char> inbuf(INPUT_BUF_SZ);
-    std::vector<unsigned char> outbuf;
-    outbuf.reserve(OUTPUT_BUF_SZ);
-
-    // Decodificar bit a bit con buffer
-    HuffNode* node = root;
-    uint64_t written = 0;
-    ssize_t rr;
-    
-    while ((rr = readFile(inputFd, inbuf.data(), INPUT_BUF_SZ)) > 0 && written < origSize) {
-        for (ssize_t i = 0; i < rr && written < origSize; ++i) {
-            unsigned char b = inbuf[i];
-            // procesar 8 bits, de msb a lsb
-            for (int bit = 7; bit >= 0 && written < origSize; --bit) {
-                int v = (b >> bit) & 1;
-                node = (v == 0) ? node->left : node->right;
-                
-                if (!node->left && !node->right) {
-                    // Nodo hoja encontrado
-                    outbuf.push_back(node->ch);
-                    ++written;
-                    node = root;
-                    
-                    // Flush buffer cuando esté lleno
-                    if (outbuf.size() >= OUTPUT_BUF_SZ) {
-                        writeFile(outputFd, outbuf.data(), outbuf.size());
-                        outbuf.clear();
-                    }
-                }
-            }
+// Desde este tamaño las tramas de un archivo regular se codifican en paralelo
+static constexpr long long HUFFMAN_PARALLEL_MIN_SIZE = 2 * static_cast<long long>(HUFFMAN_BLOCK_SIZE);
+
+// Las tramas son independientes: el lector toma cada bloque del mapeo (o con pread),
+// los hilos de cómputo las codifican y el escritor las emite en orden, así que la
+// salida es idéntica a la del streaming secuencial
+static bool compressHuffmanBlocks(ByteSource &source, ByteSink &sink, long long size) {
+    const uint8_t* view = source.data();
+    int fd = source.fd();
+    size_t frames = static_cast<size_t>((size + HUFFMAN_BLOCK_SIZE - 1) / HUFFMAN_BLOCK_SIZE);
+    auto frameLen = [&](size_t i) {
+        return static_cast<size_t>(std::min<long long>(HUFFMAN_BLOCK_SIZE, size - static_cast<long long>(i) * HUFFMAN_BLOCK_SIZE));
+    };
+
+    StagedExecutor::BlockTask task;
+    task.read = [&](size_t i, ByteBuffer &buf) -> const uint8_t* {
+        long long off = static_cast<long long>(i) * HUFFMAN_BLOCK_SIZE;
+        if (view) return view + off;
+        size_t len = frameLen(i);
+        buf.resize(len);
+        if (readFileAt(fd, buf.data(), len, off) != static_cast<ssize_t>(len)) return nullptr;
+        return buf.data();
+    };
+    task.compute = [&](size_t i, const uint8_t* in, ByteBuffer &out) {
+        BufferPoolScope memory(BufferPool::current());
+        HuffNode* nodes = BufferPool::current().arena().allocateArray<HuffNode>(HUFF_MAX_NODES);
+        PooledBuffer bits(outputBufSize());
+        ByteBufferSink frame(out);
+        return encodeHuffmanFrame(in, frameLen(i), nodes, *bits, frame);
+    };
+    task.write = [&](size_t, const uint8_t* data, size_t len) {
+        return sink.write(data, len) != -1;
+    };
+    return StagedExecutor::runBlocks(frames, task);
+}
+
+bool compressHuffmanStream(ByteSource &source, ByteSink &sink) {
+    // Con vista, lo que queda por leer; si no, el archivo completo (fd() exige estar al inicio)
+    long long size = source.data() ? static_cast<long long>(source.dataSize()) : source.size();
+    if (size >= HUFFMAN_PARALLEL_MIN_SIZE && (source.data() || source.fd() >= 0)) {
+        return compressHuffmanBlocks(source, sink, size);
+    }
+    BufferPoolScope memory(BufferPool::current());
+    if (const uint8_t* view = source.data()) {
+        // Vista contigua: cada trama se codifica directamente desde el mapeo, sin
+        // acumularla antes en un buffer (mismas tramas que HuffmanCompressor)
+        HuffNode* nodes = BufferPool::current().arena().allocateArray<HuffNode>(HUFF_MAX_NODES);
+        PooledBuffer bits(outputBufSize());
+        size_t total = source.dataSize();
+        for (size_t off = 0; off < total; off += HUFFMAN_BLOCK_SIZE) {
+            size_t len = std::min(HUFFMAN_BLOCK_SIZE, total - off);
+            if (!encodeHuffmanFrame(view + off, len, nodes, *bits, sink)) return false;
         }
+        return true;
     }
+    return runTransform(source, *makeHuffmanCompressor(), sink);
+}
 
-    // Flush buffer final
-    if (!outbuf.empty()) {
-        writeFile(outputFd, outbuf.data(), outbuf.size());
-    }
+bool decompressHuffmanStream(ByteSource &source, ByteSink &sink) {
+    BufferPoolScope memory(BufferPool::current());
+    return runTransform(source, *makeHuffmanDecompressor(), sink);
+}
+
+// --- Variantes por ruta: abren los archivos y delegan en la versión por streams ---
+
+void compressRLE(const std::string &inputPath, const std::string &outputPath) {
+    transformFile(inputPath, outputPath, compressRLEStream);
+}
+
+void decompressRLE(const std::string &inputPath, const std::string &outputPath) {
+    transformFile(inputPath, outputPath, decompressRLEStream);
+}
 
-    freeTree(root);
-    closeFile(inputFd);
-    closeFile(outputFd);
-}
\ No newline at end of file
+void compressLZW(const std::string &inputPath, const std::string &outputPath) {
+    transformFile(inputPath, outputPath, compressLZWStream);
+}
+
+void decompressLZW(const std::string &inputPath, const std::string &outputPath) {
+    transformFile(inputPath, outputPath, decompressLZWStream);
+}
+
+void compressHuffman(const std::string &inputPath, const std::string &outputPath) {
+    transformFile(inputPath, outputPath, compressHuffmanStream);
+}
+
+void decompressHuffman(const std::string &inputPath, const std::string &outputPath) {
+    transformFile(inputPath, outputPath, decompressHuffmanStream);
+}
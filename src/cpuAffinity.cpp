@@ -0,0 +1,108 @@
+#include "cpuAffinity.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <set>
+
+// CPUs de los workers, ya ordenadas alternando nodos
+static std::vector<int> workerCpus;
+
+bool parseCpuList(const std::string &text, std::vector<int> &cpus) {
+    cpus.clear();
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        std::string item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        if (item.empty()) return false;
+
+        char* end = nullptr;
+        long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (end == item.c_str() || first < 0) return false;
+        if (*end == '-') {
+            const char* rest = end + 1;
+            last = std::strtol(rest, &end, 10);
+            if (end == rest || last < first) return false;
+        }
+        if (*end != '\0' || last >= CPU_SETSIZE) return false;
+        for (long c = first; c <= last; ++c) cpus.push_back(static_cast<int>(c));
+
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    return !cpus.empty();
+}
+
+std::vector<int> availableCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+int cpuNode(int cpu) {
+    // Cada nodo publica sus CPUs en /sys/devices/system/node/nodeN/cpulist
+    static std::map<int, int> nodes;
+    static bool loaded = false;
+    if (!loaded) {
+        loaded = true;
+        for (int node = 0; node < 1024; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file) {
+                if (node > 0) break;
+                continue;
+            }
+            std::string list;
+            std::getline(file, list);
+            std::vector<int> cpus;
+            if (!parseCpuList(list, cpus)) continue;
+            for (int c : cpus) nodes[c] = node;
+        }
+    }
+    auto it = nodes.find(cpu);
+    return it == nodes.end() ? 0 : it->second;
+}
+
+bool setWorkerCpus(const std::vector<int> &cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::set<int> unique(cpus.begin(), cpus.end());
+    for (int c : unique) CPU_SET(c, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        perror("Error al fijar las CPUs del proceso");
+        return false;
+    }
+
+    // Agrupar por nodo y tomar una CPU de cada nodo por vuelta
+    std::map<int, std::vector<int>> byNode;
+    for (int c : unique) byNode[cpuNode(c)].push_back(c);
+    workerCpus.clear();
+    for (size_t round = 0; workerCpus.size() < unique.size(); ++round) {
+        for (auto &entry : byNode) {
+            if (round < entry.second.size()) workerCpus.push_back(entry.second[round]);
+        }
+    }
+    return true;
+}
+
+size_t workerCpuCount() {
+    return workerCpus.size();
+}
+
+void pinWorkerThread(size_t index) {
+    if (workerCpus.empty()) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(workerCpus[index % workerCpus.size()], &set);
+    // Best-effort: si falla, el hilo sigue en el conjunto del proceso
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
@@ -3,11 +3,22 @@
 #include <unistd.h>     // read, write, close
 #include <dirent.h>     // opendir, readdir, closedir
 #include <sys/stat.h>   // stat
+#include <sys/mman.h>   // mmap, madvise
+#include <cstdio>       // perror, rename
 #include <string>
 #include <vector>
 #include <iostream>
+#include <atomic>
 #include <errno.h>
 
+static IoBackend ioBackend = IoBackend::Auto;
+static IoPolicy ioPolicy;
+static bool directIo = false;
+
+// Con --direct-io las escrituras se descartan de la caché una ventana por detrás de la
+// posición actual, cuando el kernel ya terminó de escribirlas
+static constexpr long long WRITE_BEHIND = 16LL * 1024 * 1024;
+
 int openFile(const std::string &path, int flags, int permissions) {
     int fd = open(path.c_str(), flags, permissions);
     if (fd == -1) {
@@ -36,13 +47,236 @@ ssize_t writeFile(int fd, const void* buffer, size_t size) {
     return bytesWritten;
 }
 
+ssize_t readFull(int fd, void* buffer, size_t size) {
+    char* dst = static_cast<char*>(buffer);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = read(fd, dst + total, size - total);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("Error al leer archivo");
+            return -1;
+        }
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+ssize_t writeAll(int fd, const void* buffer, size_t size) {
+    const char* src = static_cast<const char*>(buffer);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = write(fd, src + total, size - total);
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("Error al escribir en el archivo");
+            return -1;
+        }
+        total += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+ssize_t readFileAt(int fd, void* buffer, size_t size, long long offset) {
+    char* dst = static_cast<char*>(buffer);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = pread(fd, dst + total, size - total, static_cast<off_t>(offset + total));
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("Error al leer archivo");
+            return -1;
+        }
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    if (directIo) releaseReadRange(fd, offset, static_cast<long long>(total));
+    return static_cast<ssize_t>(total);
+}
+
+ssize_t writeFileAt(int fd, const void* buffer, size_t size, long long offset) {
+    const char* src = static_cast<const char*>(buffer);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = pwrite(fd, src + total, size - total, static_cast<off_t>(offset + total));
+        if (n == -1) {
+            if (errno == EINTR) continue;
+            perror("Error al escribir en el archivo");
+            return -1;
+        }
+        total += static_cast<size_t>(n);
+    }
+    if (directIo) releaseWrittenRange(fd, offset, static_cast<long long>(total));
+    return static_cast<ssize_t>(total);
+}
+
+bool setFileSize(int fd, long long size) {
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+        perror("Error al ajustar el tamaño del archivo");
+        return false;
+    }
+    return true;
+}
+
+bool preallocateFile(int fd, long long size) {
+    if (size <= 0 || !ioPolicy.preallocate) return false;
+    // Sin perror: si no se puede reservar, el archivo crece con las escrituras como siempre
+    return fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) == 0;
+}
+
+void trimPreallocation(int fd) {
+    // Truncar al mismo tamaño libera los bloques reservados después del final
+    long long size = getFileSize(fd);
+    if (size >= 0) setFileSize(fd, size);
+}
+
 void closeFile(int fd) {
+    if (directIo) {
+        // Iniciar la escritura de lo que quede y soltar las páginas que ya estén limpias
+        sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
     int closed = close(fd);
     if (closed == -1) {
         perror("Error al cerrar el archivo");
     }
 }
 
+// Directorio y nombre de una ruta de salida ("." si no tiene directorio)
+static void splitOutputPath(const std::string &path, std::string &dir, std::string &name) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos) {
+        dir = ".";
+        name = path;
+    } else {
+        dir = (slash == 0) ? "/" : path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+// Nombre temporal único (por proceso e hilo) junto a la ruta final
+static std::string makeTempPath(const std::string &dir, const std::string &name) {
+    static std::atomic<unsigned long> counter{0};
+    return dir + "/." + name + ".tmp." + std::to_string(getpid()) + "." +
+           std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+// linkat sobre /proc/self/fd no requiere privilegios (AT_EMPTY_PATH sí)
+static bool procFdAvailable() {
+    static const bool available = access("/proc/self/fd", X_OK) == 0;
+    return available;
+}
+
+bool createOutputFile(const std::string &path, OutputFile &out) {
+    out = OutputFile();
+    out.path = path;
+
+    struct stat st;
+    bool exists = lstat(path.c_str(), &st) == 0;
+    if (exists && !S_ISREG(st.st_mode)) {
+        // Dispositivos, FIFOs y enlaces simbólicos se escriben en su lugar, como antes
+        out.fd = openFile(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return out.fd != -1;
+    }
+    out.replace = exists;
+
+    std::string dir, name;
+    splitOutputPath(path, dir, name);
+    if (procFdAvailable()) {
+        out.fd = open(dir.c_str(), O_TMPFILE | O_WRONLY, 0644);
+        out.anonymous = out.fd != -1;
+    }
+    if (out.fd == -1) {
+        // Sin O_TMPFILE (p. ej. NFS o kernels viejos): temporal con nombre
+        for (int attempt = 0; attempt < 16 && out.fd == -1; ++attempt) {
+            out.tempPath = makeTempPath(dir, name);
+            out.fd = open(out.tempPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+            if (out.fd == -1 && errno != EEXIST) break;
+        }
+        if (out.fd == -1) {
+            perror(("Error al abrir archivo: " + path).c_str());
+            out.tempPath.clear();
+            return false;
+        }
+    }
+    // Al reemplazar una salida existente se conservan sus permisos
+    if (exists) fchmod(out.fd, st.st_mode & 07777);
+    return true;
+}
+
+bool commitOutputFile(OutputFile &out) {
+    if (out.fd == -1) return false;
+    bool ok = true;
+    // Los datos van a disco antes que el nombre: si no, tras una caída ext4/XFS pueden
+    // dejar en la ruta final un archivo vacío o a medias
+    bool atomic = out.anonymous || !out.tempPath.empty();
+    if (atomic && getIoPolicy().syncOutputs && fdatasync(out.fd) != 0) {
+        perror(("Error al sincronizar archivo: " + out.path).c_str());
+        ok = false;
+    }
+    if (ok && out.anonymous) {
+        std::string procPath = "/proc/self/fd/" + std::to_string(out.fd);
+        // Si la ruta final no existe basta enlazar; si existe, enlazar a un temporal y
+        // renombrarlo encima (rename reemplaza de forma atómica, linkat no)
+        if (out.replace || linkat(AT_FDCWD, procPath.c_str(), AT_FDCWD, out.path.c_str(), AT_SYMLINK_FOLLOW) != 0) {
+            if (!out.replace && errno != EEXIST) {
+                perror(("Error al publicar archivo: " + out.path).c_str());
+                ok = false;
+            } else {
+                std::string dir, name;
+                splitOutputPath(out.path, dir, name);
+                out.tempPath = makeTempPath(dir, name);
+                if (linkat(AT_FDCWD, procPath.c_str(), AT_FDCWD, out.tempPath.c_str(), AT_SYMLINK_FOLLOW) != 0) {
+                    perror(("Error al publicar archivo: " + out.path).c_str());
+                    out.tempPath.clear();
+                    ok = false;
+                }
+            }
+        }
+    }
+    if (ok && !out.tempPath.empty() && rename(out.tempPath.c_str(), out.path.c_str()) != 0) {
+        perror(("Error al publicar archivo: " + out.path).c_str());
+        ok = false;
+    }
+    if (!ok && !out.tempPath.empty()) unlink(out.tempPath.c_str());
+    closeFile(out.fd);
+    out = OutputFile();
+    return ok;
+}
+
+void abortOutputFile(OutputFile &out) {
+    if (out.fd == -1) return;
+    // Un archivo anónimo desaparece solo al cerrarlo
+    if (!out.tempPath.empty()) unlink(out.tempPath.c_str());
+    closeFile(out.fd);
+    out = OutputFile();
+}
+
+bool mapFile(int fd, MappedFile &view) {
+    view = MappedFile();
+    long long size = getFileSize(fd);
+    if (size < 0) return false;
+    if (size == 0) return true; // archivo vacío: nada que mapear
+    void* p = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        perror("Error al mapear archivo en memoria");
+        return false;
+    }
+    // Lectura de principio a fin: readahead agresivo y liberar páginas ya leídas;
+    // WILLNEED además empieza a traer el archivo antes de que se lo toque
+    madvise(p, static_cast<size_t>(size), MADV_SEQUENTIAL);
+    madvise(p, static_cast<size_t>(size), MADV_WILLNEED);
+    view.data = static_cast<const uint8_t*>(p);
+    view.size = static_cast<size_t>(size);
+    return true;
+}
+
+void unmapFile(MappedFile &view) {
+    if (view.data) munmap(const_cast<uint8_t*>(view.data), view.size);
+    view = MappedFile();
+}
+
 bool isDirectory(const std::string &path) {
     struct stat pathStat;
     if (stat(path.c_str(), &pathStat) != 0)
@@ -79,6 +313,14 @@ long long getFileSize(const std::string &path) {
     return -1;
 }
 
+long long getFileSize(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        return static_cast<long long>(st.st_size);
+    }
+    return -1;
+}
+
 bool ensureDirectoryExists(const std::string &path) {
     if (path.empty()) return false;
 
@@ -185,4 +427,66 @@ std::string formatTime(double seconds) {
     }
     
     return std::string(buffer);
-}
\ No newline at end of file
+}
+
+static size_t roundToPage(size_t size) {
+    const size_t page = 4096;
+    return size < page ? page : (size + page - 1) / page * page;
+}
+
+void setIoPolicy(const IoPolicy &policy) {
+    ioPolicy = policy;
+    ioPolicy.blockSize = roundToPage(policy.blockSize);
+    ioPolicy.streamBufferSize = roundToPage(policy.streamBufferSize);
+}
+
+const IoPolicy& getIoPolicy() {
+    return ioPolicy;
+}
+
+void adviseSequential(int fd) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+bool prefetchFile(const std::string &path, size_t bytes) {
+    // Sin perror: es solo una sugerencia, el error real aparece al procesar el archivo
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+    posix_fadvise(fd, 0, static_cast<off_t>(bytes), POSIX_FADV_WILLNEED);
+    close(fd);
+    return true;
+}
+
+void setDirectIo(bool enabled) {
+    directIo = enabled;
+}
+
+bool directIoEnabled() {
+    return directIo;
+}
+
+void releaseReadRange(int fd, long long offset, long long length) {
+    if (length > 0) posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+}
+
+void releaseWrittenRange(int fd, long long offset, long long length) {
+    if (length <= 0) return;
+    // Empezar ya la escritura a disco del rango, sin esperarla
+    sync_file_range(fd, static_cast<off_t>(offset), static_cast<off_t>(length), SYNC_FILE_RANGE_WRITE);
+    // Al cruzar cada ventana, esperar la anterior (normalmente ya escrita) y descartarla
+    long long end = offset + length;
+    if (end / WRITE_BEHIND == offset / WRITE_BEHIND) return;
+    long long settled = (end / WRITE_BEHIND - 1) * WRITE_BEHIND;
+    if (settled <= 0) return;
+    sync_file_range(fd, 0, static_cast<off_t>(settled),
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    posix_fadvise(fd, 0, static_cast<off_t>(settled), POSIX_FADV_DONTNEED);
+}
+
+void setIoBackend(IoBackend backend) {
+    ioBackend = backend;
+}
+
+IoBackend getIoBackend() {
+    return ioBackend;
+}
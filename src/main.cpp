@@ -2,9 +2,13 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <fcntl.h>          // O_RDONLY
 #include "fileManager.h"        // Para manejar la entrada/salida de archivos
 #include "compression.h"         // Para compresión
 #include "encryption.h"          // Para encriptación
+#include "pipeline.h"            // Para encadenar operaciones en memoria
 #include "Journal.h"             // Para journaling de operaciones
 #include <chrono>
 #include <mutex>
@@ -12,7 +16,14 @@
 #include <iomanip>
 #include <unordered_map>
 #include <algorithm>
-#include "ThreadPool.h"          // Thread pool para procesamiento concurrente
+#include <atomic>
+#include <thread>
+#include <memory>
+#include "StagedExecutor.h"      // Lector -> cómputo -> escritor para procesamiento concurrente
+#include "DirectoryWalker.h"     // Recorrido paralelo de carpetas
+#include "Manifest.h"            // --incremental: omitir archivos sin cambios
+#include "ThreadPool.h"          // Pool compartido para los bloques de archivos grandes
+#include "cpuAffinity.h"         // -j y --cpus: cantidad y ubicación de los workers
 #include "TableFormatter.h"      // Para formatear salida en tablas
 
 // Mutex global para sincronizar la salida a consola de forma thread-safe
@@ -28,7 +39,17 @@ struct FileResult {
     std::string status;
 };
 
-// Vector global thread-safe para acumular resultados
+// Ajustar automáticamente cuántos hilos procesan archivos (se desactiva con -j)
+static bool adaptiveConcurrency = true;
+
+// --incremental: omitir los archivos que no cambiaron desde la corrida anterior
+// (con --incremental-hash también se compara el contenido cuando cambió el mtime)
+static bool incrementalMode = false;
+static bool incrementalHash = false;
+
+// Vector global thread-safe para acumular resultados. Guarda una fila por archivo para
+// la tabla final, así que en una carpeta la memoria pico sigue siendo O(archivos)
+// (la cola de tareas y el ejecutor sí están acotados)
 static std::vector<FileResult> globalResults;
 static std::mutex results_mutex;
 
@@ -40,23 +61,27 @@ static void printLockedStream(const std::function<void(std::ostream&)> &fn) {
     std::cout << oss.str();
 }
 
-// Función auxiliar para generar nombres de archivos temporales únicos
-static std::string makeTempName(const std::string &output_path, size_t op_idx, const std::string &input_path) {
-    auto h = std::hash<std::string>{}(input_path);
-    return output_path + ".tmp." + std::to_string(op_idx) + "." + std::to_string(h);
-}
+// Función para procesar un solo archivo con las operaciones especificadas.
+// Si se pasan source/sink (ejecutor por etapas) los datos llegan y salen por ellos
+// en lugar de abrir las rutas. 'inFolder' indica que el archivo es parte de una carpeta
+// y 'outputSizeHint' es el tamaño estimado de la salida (0 si no se conoce).
+// Retorna true si el procesamiento tuvo éxito.
+bool processFile(const std::string& input_path, const std::string& output_path, const std::vector<char>& operations, const std::string& comp_algorithm, const std::string& enc_algorithm, const std::string& key, Journal* journal = nullptr, bool inFolder = false, ByteSource* source = nullptr, ByteSink* sink = nullptr, long long outputSizeHint = 0, FileResult* resultOut = nullptr) {
+    // Cada operación se traduce en una etapa del pipeline: los datos intermedios
+    // fluyen por buffers en memoria y solo la salida final se escribe a disco
+    std::vector<PipelineStage> stages;
+    std::vector<std::string> completedMessages;
 
-// Función para procesar un solo archivo con las operaciones especificadas
-void processFile(const std::string& input_path, const std::string& output_path, const std::vector<char>& operations, const std::string& comp_algorithm, const std::string& enc_algorithm, const std::string& key, Journal* journal = nullptr, int fileNum = 1, int totalFiles = 1) {
-    std::string current_input = input_path;  // El archivo individual
-    std::vector<std::string> temp_files;
-    
-    long long originalSize = getFileSize(current_input);
+    // "-" indica stdin/stdout: su tamaño se mide contando los bytes que pasan
+    bool fromStdin = (input_path == "-");
+    bool toStdout = (output_path == "-");
+
+    long long originalSize = fromStdin ? 0 : getFileSize(input_path);
     long long totalTime = 0;
     std::string status = "OK";
 
     // Obtener nombre base del archivo
-    std::string baseName = input_path;
+    std::string baseName = fromStdin ? "stdin" : input_path;
     size_t lastSlash = baseName.find_last_of('/');
     if (lastSlash != std::string::npos) {
         baseName = baseName.substr(lastSlash + 1);
@@ -76,7 +101,7 @@ void processFile(const std::string& input_path, const std::string& output_path,
     };
 
     // Si hay journal y es una carpeta, escribir separador en buffer
-    if (journal && totalFiles > 1) {
+    if (journal && inFolder) {
         logBuffer << "\n";
         logBuffer << "----------------------------------------\n";
         logBuffer << baseName << "\n";
@@ -88,9 +113,6 @@ void processFile(const std::string& input_path, const std::string& output_path,
     // Iterar sobre cada operación en la cadena
     for (size_t idx = 0; idx < operations.size(); ++idx) {
         char op = operations[idx];
-        bool last = (idx == operations.size() - 1);
-        std::string target = last ? output_path : makeTempName(output_path, idx, input_path);
-        if (!last) temp_files.push_back(target);
 
         // Registrar inicio de operación específica
         std::string opName;
@@ -163,8 +185,9 @@ void processFile(const std::string& input_path, const std::string& output_path,
                 }
             }
             
-            // Mostrar sugerencia solo para archivos individuales (no para carpetas)
-            if (shouldSuggest && totalFiles == 1) {
+            // Mostrar sugerencia solo para archivos individuales (no para carpetas).
+            // Con -i - stdin transporta los datos y no puede usarse para preguntar.
+            if (shouldSuggest && !inFolder && !fromStdin) {
                 // Si la sugerencia incluye múltiples opciones (Huffman o LZW)
                 if (suggestedAlgorithm.find("o") != std::string::npos) {
                     std::ostringstream suggestion;
@@ -233,134 +256,155 @@ void processFile(const std::string& input_path, const std::string& output_path,
                 }
             }  
             // Compresión
-            auto t1 = std::chrono::steady_clock::now();
             if (comp_algorithm == "RLE") {
-                compressRLE(current_input, target);
+                stages.push_back({compressRLEStream, makeRLECompressor});
             } else if (comp_algorithm == "LZW") {
-                compressLZW(current_input, target);
+                stages.push_back({compressLZWStream, makeLZWCompressor});
             } else if (comp_algorithm == "Huff" || comp_algorithm == "Huffman") {
-                compressHuffman(current_input, target);
+                stages.push_back({compressHuffmanStream, makeHuffmanCompressor});
             } else {
                 std::ostringstream oss;
                 oss << "Algoritmo de compresión no soportado: " << comp_algorithm << "\n";
-                for (auto &f : temp_files) std::remove(f.c_str());
                 if (journal) {
                     addLogToBuffer() << "ERROR: " << oss.str();
                     journal->logBlock(logBuffer.str());
                 }
                 printLockedStream([&](std::ostream &os){ os << oss.str(); });
-                return;
+                return false;
             }
-            auto t2 = std::chrono::steady_clock::now();
-            totalTime += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-            if (journal) addLogToBuffer() << "Compresión completada\n";
+            completedMessages.push_back("Compresión completada");
         } else if (op == 'd') {
             // Descompresión
-            auto t1 = std::chrono::steady_clock::now();
             if (comp_algorithm == "RLE") {
-                decompressRLE(current_input, target);
+                stages.push_back({decompressRLEStream, makeRLEDecompressor});
             } else if (comp_algorithm == "LZW") {
-                decompressLZW(current_input, target);
+                stages.push_back({decompressLZWStream, makeLZWDecompressor});
             } else if (comp_algorithm == "Huff" || comp_algorithm == "Huffman") {
-                decompressHuffman(current_input, target);
+                stages.push_back({decompressHuffmanStream, makeHuffmanDecompressor});
             } else {
                 std::ostringstream oss;
                 oss << "Algoritmo de descompresión no soportado: " << comp_algorithm << "\n";
-                for (auto &f : temp_files) std::remove(f.c_str());
                 if (journal) {
                     addLogToBuffer() << "ERROR: " << oss.str();
                     journal->logBlock(logBuffer.str());
                 }
                 printLockedStream([&](std::ostream &os){ os << oss.str(); });
-                return;
+                return false;
             }
-            auto t2 = std::chrono::steady_clock::now();
-            totalTime += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-            if (journal) addLogToBuffer() << "Descompresión completada\n";
+            completedMessages.push_back("Descompresión completada");
         } else if (op == 'e') {
             // Encriptación
             if (key.empty()) {
                 std::ostringstream oss;
                 oss << "Debe especificar la clave con -k\n";
-                for (auto &f : temp_files) std::remove(f.c_str());
                 if (journal) {
                     addLogToBuffer() << "ERROR: " << oss.str();
                     journal->logBlock(logBuffer.str());
                 }
                 printLockedStream([&](std::ostream &os){ os << oss.str(); });
-                return;
+                return false;
             }
-            auto t1 = std::chrono::steady_clock::now();
             if (enc_algorithm == "VIG" || enc_algorithm == "VIGENERE" || enc_algorithm == "Vigenere") {
-                encryptVigenere(current_input, target, key);
+                stages.push_back({[&key](ByteSource &in, ByteSink &out) { return encryptVigenereStream(in, out, key); },
+                                  [&key] { return makeVigenereEncryptor(key); }});
             } else if (enc_algorithm == "AES" || enc_algorithm == "AES128" || enc_algorithm == "AES-128") {
-                encryptAES128(current_input, target, key);
+                stages.push_back({[&key](ByteSource &in, ByteSink &out) { return encryptAES128Stream(in, out, key); },
+                                  [&key] { return makeAES128Encryptor(key); }});
+            } else if (enc_algorithm == "CHACHA20" || enc_algorithm == "ChaCha20" || enc_algorithm == "CHACHA") {
+                stages.push_back({[&key](ByteSource &in, ByteSink &out) { return encryptChaCha20Stream(in, out, key); },
+                                  [&key] { return makeChaCha20Encryptor(key); }});
             } else {
                 std::ostringstream oss;
                 oss << "Algoritmo de encriptación no soportado: " << enc_algorithm << "\n";
-                for (auto &f : temp_files) std::remove(f.c_str());
                 if (journal) {
                     addLogToBuffer() << "ERROR: " << oss.str();
                     journal->logBlock(logBuffer.str());
                 }
                 printLockedStream([&](std::ostream &os){ os << oss.str(); });
-                return;
+                return false;
             }
-            auto t2 = std::chrono::steady_clock::now();
-            totalTime += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-            if (journal) addLogToBuffer() << "Encriptación completada\n";
+            completedMessages.push_back("Encriptación completada");
         } else if (op == 'u') {
             // Desencriptación
             if (key.empty()) {
                 std::ostringstream oss;
                 oss << "Debe especificar la clave con -k\n";
-                for (auto &f : temp_files) std::remove(f.c_str());
                 if (journal) {
                     addLogToBuffer() << "ERROR: " << oss.str();
                     journal->logBlock(logBuffer.str());
                 }
                 printLockedStream([&](std::ostream &os){ os << oss.str(); });
-                return;
+                return false;
             }
-            auto t1 = std::chrono::steady_clock::now();
             if (enc_algorithm == "VIG" || enc_algorithm == "VIGENERE" || enc_algorithm == "Vigenere") {
-                decryptVigenere(current_input, target, key);
+                stages.push_back({[&key](ByteSource &in, ByteSink &out) { return decryptVigenereStream(in, out, key); },
+                                  [&key] { return makeVigenereDecryptor(key); }});
             } else if (enc_algorithm == "AES" || enc_algorithm == "AES128" || enc_algorithm == "AES-128") {
-                decryptAES128(current_input, target, key);
+                stages.push_back({[&key](ByteSource &in, ByteSink &out) { return decryptAES128Stream(in, out, key); },
+                                  [&key] { return makeAES128Decryptor(key); }});
+            } else if (enc_algorithm == "CHACHA20" || enc_algorithm == "ChaCha20" || enc_algorithm == "CHACHA") {
+                stages.push_back({[&key](ByteSource &in, ByteSink &out) { return decryptChaCha20Stream(in, out, key); },
+                                  [&key] { return makeChaCha20Decryptor(key); }});
             } else {
                 std::ostringstream oss;
                 oss << "Algoritmo de desencriptación no soportado: " << enc_algorithm << "\n";
-                for (auto &f : temp_files) std::remove(f.c_str());
                 if (journal) {
                     addLogToBuffer() << "ERROR: " << oss.str();
                     journal->logBlock(logBuffer.str());
                 }
                 printLockedStream([&](std::ostream &os){ os << oss.str(); });
-                return;
+                return false;
             }
-            auto t2 = std::chrono::steady_clock::now();
-            totalTime += std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-            if (journal) addLogToBuffer() << "Desencriptación completada\n";
+            completedMessages.push_back("Desencriptación completada");
         } else {
             std::ostringstream oss;
             oss << "Operación desconocida: " << op << "\n";
-            for (auto &f : temp_files) std::remove(f.c_str());
             if (journal) {
                 addLogToBuffer() << "ERROR: " << oss.str();
                 journal->logBlock(logBuffer.str());
             }
             printLockedStream([&](std::ostream &os){ os << oss.str(); });
-            return;
+            return false;
         }
+    }
 
-        // Preparar input para la siguiente operación (si no es la última)
-        if (!last) {
-            current_input = target;
+    // Ejecutar la cadena completa: entrada -> etapas -> salida.
+    // Las etapas toman buffers y tablas de la memoria de este worker, que se reutiliza entre archivos
+    WorkerMemory &memory = WorkerMemory::local();
+    auto t1 = std::chrono::steady_clock::now();
+    long long streamedIn = -1, streamedOut = -1;
+    bool ok;
+    if (source && sink) {
+        // El escritor puede no haber terminado aún: el tamaño final se cuenta aquí
+        CountingSink countedOut(*sink);
+        ok = runPipeline(*source, countedOut, stages, &memory);
+        streamedOut = countedOut.count();
+    } else {
+        ok = transformFile(input_path, output_path, [&](ByteSource &in, ByteSink &out) {
+            if (!fromStdin && !toStdout) return runPipeline(in, out, stages, &memory);
+            CountingSource countedIn(in);
+            CountingSink countedOut(out);
+            bool res = runPipeline(fromStdin ? static_cast<ByteSource&>(countedIn) : in,
+                                   toStdout ? static_cast<ByteSink&>(countedOut) : out, stages, &memory);
+            streamedIn = countedIn.count();
+            streamedOut = countedOut.count();
+            return res;
+        }, outputSizeHint);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    if (!ok) status = "ERROR";
+    if (journal) {
+        if (ok) {
+            for (auto &msg : completedMessages) addLogToBuffer() << msg << "\n";
+        } else {
+            addLogToBuffer() << "ERROR: falló el procesamiento de " << baseName << "\n";
         }
     }
 
     // Obtener tamaño final y calcular ratio
-    long long finalSize = getFileSize(output_path);
+    if (fromStdin) originalSize = streamedIn;
+    long long finalSize = (toStdout || sink) ? streamedOut : getFileSize(output_path);
     double ratio = (originalSize > 0) ? (100.0 * (originalSize - finalSize) / originalSize) : 0.0;
     
     // Registrar completado en journal (en buffer)
@@ -375,77 +419,89 @@ void processFile(const std::string& input_path, const std::string& output_path,
     
     // Crear resultado y agregarlo al vector global
     FileResult result;
-    result.filename = input_path;
+    result.filename = fromStdin ? "stdin" : input_path;
     result.originalSize = originalSize;
     result.finalSize = finalSize;
     result.ratio = ratio;
     result.timeMs = totalTime;
     result.status = status;
     
-    // Agregar resultado de forma thread-safe
+    // Con resultOut lo agrega quien llama (cuando sabe si la salida se pudo guardar)
+    if (resultOut) {
+        *resultOut = std::move(result);
+        return ok;
+    }
     {
         std::lock_guard<std::mutex> lock(results_mutex);
-        globalResults.push_back(result);
-    }
-
-    // Limpiar temporales intermedios
-    for (auto &f : temp_files) {
-        if (std::remove(f.c_str()) != 0) {
-            // intento de limpieza; ignorar errores
-        }
+        globalResults.push_back(std::move(result));
     }
+    return ok;
 }
 
-// Función recursiva para recolectar todos los archivos en un directorio
-static void collectFilesRecursively(const std::string &in_path, const std::string &out_path, std::vector<std::pair<std::string,std::string>> &acc) {
-    if (isDirectory(in_path)) {
-        // Es un directorio: crear estructura y procesar recursivamente
-        ensureDirectoryExists(out_path);
-        std::vector<std::string> files = listFiles(in_path);
-        
-        // Normalizar in_path: eliminar barra final si existe
-        std::string normalized_in = in_path;
-        if (!normalized_in.empty() && normalized_in.back() == '/') {
-            normalized_in.pop_back();
-        }
-        
-        // Normalizar out_path: eliminar barra final si existe
-        std::string normalized_out = out_path;
-        if (!normalized_out.empty() && normalized_out.back() == '/') {
-            normalized_out.pop_back();
-        }
-        
-        for (const auto &entry : files) {
-            std::string sub_in = normalized_in + "/" + entry;
-            std::string sub_out = normalized_out + "/" + entry;
-            collectFilesRecursively(sub_in, sub_out, acc);
+// Archivos desde este tamaño se procesan directamente (mmap y bloques en paralelo)
+// en lugar de pasar en bloques por los hilos lector y escritor
+static constexpr long long DIRECT_MIN_SIZE = 16LL * 1024 * 1024;
+
+// Salidas desde este tamaño se reservan en disco antes de escribirlas
+static constexpr long long PREALLOCATE_MIN_SIZE = 1024 * 1024;
+
+// Tamaño que tendrá la salida de aplicar 'operations' a un archivo de 'size' bytes, para
+// reservarla de antemano. Compresión: el tamaño de entrada como cota (si los datos se
+// comprimen, el sobrante se libera al terminar). Descompresión: solo Huffman lo guarda
+// en sus cabeceras. Cifrado: IV/nonce y relleno. 0 si no puede estimarse.
+static long long estimateOutputSize(const std::string &inputPath, long long size,
+                                    const std::vector<char>& operations,
+                                    const std::string &comp_algorithm,
+                                    const std::string &enc_algorithm) {
+    bool aes = (enc_algorithm == "AES" || enc_algorithm == "AES128" || enc_algorithm == "AES-128");
+    bool chacha = (enc_algorithm == "CHACHA20" || enc_algorithm == "ChaCha20" || enc_algorithm == "CHACHA");
+    for (size_t idx = 0; idx < operations.size() && size > 0; ++idx) {
+        char op = operations[idx];
+        if (op == 'c') {
+            continue;
+        } else if (op == 'd') {
+            // Las tramas Huffman llevan el tamaño original; RLE y LZW no lo guardan
+            if (idx != 0 || (comp_algorithm != "Huff" && comp_algorithm != "Huffman")) return 0;
+            int fd = openFile(inputPath, O_RDONLY);
+            if (fd == -1) return 0;
+            size = huffmanDecodedSize(fd);
+            closeFile(fd);
+        } else if (op == 'e') {
+            if (aes) size = 16 + (size / 16 + 1) * 16;   // IV + PKCS#7
+            else if (chacha) size += 8;                  // nonce
+        } else if (op == 'u') {
+            if (aes) size -= 16;                         // el relleno se conoce al descifrar
+            else if (chacha) size -= 8;
         }
-    } else {
-        // Es un archivo: asegurar que el directorio padre existe y agregarlo a la lista
-        std::string out_parent = out_path;
-        while (out_parent.size() > 1 && out_parent.back() == '/') out_parent.pop_back();
-        size_t pos = out_parent.find_last_of('/');
-        if (pos == std::string::npos) out_parent = ".";
-        else if (pos == 0) out_parent = "/";
-        else out_parent = out_parent.substr(0, pos);
-        ensureDirectoryExists(out_parent);
-        acc.emplace_back(in_path, out_path);
     }
+    return size > 0 ? size : 0;
 }
 
-// Función para ejecutar el thread pool y procesar todas las tareas
-static void runThreadPool(const std::vector<std::pair<std::string,std::string>> &tasks,
+// Archivos y bytes que encontró el recorrido (el productor los cuenta mientras el
+// ejecutor ya procesa; se leen al final para el journal)
+struct ScanTotals {
+    std::atomic<int> files{0};
+    std::atomic<long long> bytes{0};
+};
+
+// Función para ejecutar el thread pool y procesar las tareas a medida que llegan a 'queue'
+static void runThreadPool(StagedExecutor::FileQueue &queue,
+                          const ScanTotals &totals,
+                          Manifest* manifest,
+                          bool isDirectory,
                           const std::vector<char>& operations,
                           const std::string &comp_algorithm,
                           const std::string &enc_algorithm,
                           const std::string &key,
-                          const std::string &input_path) {
-    // Crear el thread pool (usa hardware_concurrency automáticamente)
-    ThreadPool pool;
+                          const std::string &input_path,
+                          const std::string &output_path) {
+    // Crear el ejecutor por etapas (un hilo de cómputo por CPU salvo -j)
+    StagedExecutor executor;
+    executor.setAdaptive(adaptiveConcurrency);
     
     // Mensaje inicial con concurrencia y número de hilos (usando mutex)
     printLockedStream([&](std::ostream &os){
-        os << "Inicio de proceso con concurrencia: " << pool.getThreadCount() << " hilos\n\n";
+        os << "Inicio de proceso con concurrencia: " << executor.getThreadCount() << " hilos\n\n";
     });
 
     // Determinar el nombre de la operación para el journal
@@ -460,36 +516,25 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
         opName.pop_back();
     }
 
-    // Determinar si es un archivo o carpeta
-    bool isDirectory = tasks.size() > 1;
-    
     // Obtener nombre base del target
-    std::string targetName = input_path;
+    std::string targetName = (input_path == "-") ? "stdin" : input_path;
     size_t lastSlash = targetName.find_last_of('/');
     if (lastSlash != std::string::npos) {
         targetName = targetName.substr(lastSlash + 1);
     }
 
-    // Calcular tamaño total
-    long long totalSize = 0;
-    for (const auto &p : tasks) {
-        long long sz = getFileSize(p.first);
-        if (sz > 0) totalSize += sz;
-    }
-
     // Crear el journal
     Journal* journal = nullptr;
     try {
         journal = new Journal(opName, targetName, isDirectory);
         
-        // Escribir encabezado
+        // Escribir encabezado. En una carpeta los totales se completan al terminar el recorrido
         if (isDirectory) {
-            journal->writeHeader(opName, targetName, input_path, "", tasks.size(), totalSize);
+            journal->writeHeader(opName, targetName, input_path, "", -1, 0);
             journal->log("Inicio de proceso...");
-            journal->log("Escaneando carpeta...");
-            journal->log("Procesando " + std::to_string(tasks.size()) + " archivos...");
+            journal->log("Escaneando carpeta y procesando archivos a medida que se encuentran...");
         } else {
-            journal->writeHeader(opName, targetName, tasks[0].first, tasks[0].second, 1, totalSize);
+            journal->writeHeader(opName, targetName, input_path, output_path, 1, totals.bytes.load());
             journal->log("Inicio de proceso...");
         }
     } catch (const std::exception &e) {
@@ -498,19 +543,47 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
         });
     }
 
-    // Encolar todas las tareas en el thread pool
-    int fileCounter = 0;
-    for (const auto &p : tasks) {
-        fileCounter++;
-        int currentFileNum = fileCounter;
-        pool.enqueue([p, &operations, &comp_algorithm, &enc_algorithm, &key, journal, currentFileNum, &tasks]() {
-            processFile(p.first, p.second, operations, comp_algorithm, enc_algorithm, key, 
-                       journal, currentFileNum, tasks.size());
-        });
-    }
+    // Procesar todas las tareas: el lector trae los archivos, los hilos de cómputo
+    // corren la cadena de operaciones y el escritor guarda las salidas. La fila de cada
+    // archivo espera (por tarea, solo mientras está en curso) hasta que el escritor
+    // informa el resultado final
+    std::mutex pendingMutex;
+    std::unordered_map<const StagedExecutor::FileTask*, FileResult> pendingResults;
+    executor.runFiles(queue, [&](const StagedExecutor::FileTask &task, ByteSource* source, ByteSink* sink) {
+        FileResult result;
+        bool ok = processFile(task.inputPath, task.outputPath, operations, comp_algorithm, enc_algorithm, key,
+                              journal, isDirectory, source, sink, task.outputSizeHint, &result);
+        if (!result.filename.empty()) {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pendingResults[&task] = std::move(result);
+        }
+        return ok;
+    }, [&](const StagedExecutor::FileTask &task, bool ok) {
+        if (manifest) manifest->finish(task.inputPath, ok);
+        FileResult result;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            auto it = pendingResults.find(&task);
+            if (it == pendingResults.end()) return;
+            result = std::move(it->second);
+            pendingResults.erase(it);
+        }
+        // Una salida que el escritor no pudo guardar cuenta como error aunque el cómputo terminara bien
+        if (!ok) result.status = "ERROR";
+        std::lock_guard<std::mutex> lock(results_mutex);
+        globalResults.push_back(std::move(result));
+    });
 
-    // Esperar a que todas las tareas terminen
-    pool.waitForCompletion();
+    if (journal && isDirectory) {
+        journal->finalizeTotals(totals.files.load(), totals.bytes.load());
+        journal->log("Recorrido completo: " + std::to_string(totals.files.load()) + " archivos");
+    }
+    if (manifest) {
+        if (journal) journal->log("Sin cambios (omitidos): " + std::to_string(manifest->skipped()) + " archivos");
+        if (!manifest->save()) {
+            printLockedStream([&](std::ostream &os){ os << "Advertencia: No se pudo guardar el manifiesto incremental\n"; });
+        }
+    }
     
     // Determinar el encabezado apropiado según las operaciones
     std::string sizeHeader = "Procesado";
@@ -555,6 +628,7 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
     long long totalCompressed = 0;
     long long totalTime = 0;
     int totalFiles = 0;
+    int okFiles = 0;
     
     for (const auto& result : globalResults) {
         std::ostringstream ratioStream;
@@ -566,13 +640,14 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
             formatFileSize(result.finalSize),
             ratioStream.str(),
             formatTime(result.timeMs / 1000.0),
-            "✓ " + result.status
+            (result.status == "OK" ? "✓ " : "✗ ") + result.status
         });
         
         totalOriginal += result.originalSize;
         totalCompressed += result.finalSize;
         totalTime += result.timeMs;
         totalFiles++;
+        if (result.status == "OK") okFiles++;
     }
     
     // Agregar fila de totales
@@ -586,7 +661,7 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
         formatFileSize(totalCompressed),
         totalRatioStream.str(),
         formatTime(totalTime / 1000.0),
-        std::to_string(totalFiles) + "/" + std::to_string(totalFiles)
+        std::to_string(okFiles) + "/" + std::to_string(totalFiles)
     });
     
     // Imprimir la tabla
@@ -596,6 +671,14 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
     std::cout << "Tiempo Total: " << formatTime(totalTime / 1000.0) << "\n";
     std::cout << "Tasa de Procesamiento: " << std::fixed << std::setprecision(2) 
               << (totalFiles / (totalTime / 1000.0)) << " archivos/s\n";
+
+    // Concurrencia usada (con ajuste automático, el nivel elegido por el controlador)
+    std::ostringstream concurrency;
+    concurrency << "Concurrencia: " << executor.getChosenThreadCount() << " de " << executor.getThreadCount() << " hilos";
+    if (adaptiveConcurrency && executor.getThreadCount() > 1) concurrency << " (ajuste automático)";
+    concurrency << "\n";
+    std::cout << concurrency.str();
+    if (manifest) std::cout << "Sin cambios (omitidos): " << manifest->skipped() << " archivos\n";
     
     // Escribir resumen final y tabla en el journal
     if (journal) {
@@ -603,7 +686,7 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
         for (const auto &result : globalResults) {
             totalProcessed += result.originalSize;
         }
-        journal->writeSummary("EXITOSO", tasks.size(), totalProcessed);
+        journal->writeSummary("EXITOSO", totals.files.load(), totalProcessed);
         
         // Escribir la tabla de resultados en el journal
         std::ostringstream tableStream;
@@ -614,6 +697,7 @@ static void runThreadPool(const std::vector<std::pair<std::string,std::string>>
         tableStream << "\nTiempo Total: " << formatTime(totalTime / 1000.0) << "\n";
         tableStream << "Tasa de Procesamiento: " << std::fixed << std::setprecision(2) 
                      << (totalFiles / (totalTime / 1000.0)) << " archivos/s\n";
+        tableStream << concurrency.str();
         
         // Escribir todo el bloque junto sin timestamps
         journal->logBlock(tableStream.str());
@@ -634,24 +718,89 @@ void processFileOrDirectory(const std::string& input_path, const std::string& ou
         globalResults.clear();
     }
     
-    // Recolectar todos los archivos (manteniendo estructura) y procesarlos en paralelo
-    std::vector<std::pair<std::string,std::string>> tasks;
-    collectFilesRecursively(input_path, output_path, tasks);
+    bool folder = input_path != "-" && isDirectory(input_path);
+    if (folder && output_path == "-") {
+        printLockedStream([&](std::ostream &os){ os << "No se puede escribir una carpeta completa a stdout: " << input_path << std::endl; });
+        return;
+    }
+
+    // El recorrido llena una cola acotada mientras el ejecutor ya procesa los primeros
+    // archivos: en árboles grandes el cómputo no espera al escaneo y en memoria solo
+    // están las tareas pendientes, no el árbol completo
+    StagedExecutor::FileQueue queue;
+    ScanTotals totals;
+
+    // El manifiesto solo aplica a carpetas: un archivo suelto se procesa siempre
+    std::unique_ptr<Manifest> manifest;
+    if (incrementalMode && folder) {
+        std::string config(operations.begin(), operations.end());
+        config += "|" + comp_algorithm + "|" + enc_algorithm;
+        // Con encriptación la clave también invalida el manifiesto (solo se guarda su hash con sal)
+        bool usesKey = std::find(operations.begin(), operations.end(), 'e') != operations.end() ||
+                       std::find(operations.begin(), operations.end(), 'u') != operations.end();
+        manifest.reset(new Manifest(input_path, output_path, config, usesKey ? key : std::string(), incrementalHash));
+    }
+
+    auto produce = [&](WalkEntry &&entry) {
+        if (manifest && manifest->unchanged(entry)) return;
+        // Los grandes (y stdin/stdout) van por el camino directo, que los divide en bloques
+        bool stdio = (entry.inputPath == "-" || entry.outputPath == "-");
+        StagedExecutor::FileTask task{std::move(entry.inputPath), std::move(entry.outputPath),
+                                      stdio || entry.size >= DIRECT_MIN_SIZE};
+        task.inputSize = entry.size;
+        if (!stdio && entry.size >= PREALLOCATE_MIN_SIZE && getIoPolicy().preallocate) {
+            task.outputSizeHint = estimateOutputSize(task.inputPath, entry.size, operations,
+                                                     comp_algorithm, enc_algorithm);
+        }
+        totals.files.fetch_add(1);
+        if (entry.size > 0) totals.bytes.fetch_add(entry.size);
+        queue.push(std::move(task));
+    };
+
+    std::thread scanner;
+    if (folder) {
+        scanner = std::thread([&] {
+            DirectoryWalker walker;
+            walker.walk(input_path, output_path, produce);
+            queue.close();
+        });
+    } else {
+        // Un solo archivo (o stdin/stdout): la tarea se conoce antes de empezar
+        if (input_path == "-" || output_path == "-") {
+            produce({input_path, output_path, input_path == "-" ? -1 : getFileSize(input_path), 0, 0});
+        } else {
+            DirectoryWalker().walk(input_path, output_path, produce);
+        }
+        queue.close();
+    }
 
-    if (tasks.empty()) {
+    if (!queue.waitForTask()) {
+        if (scanner.joinable()) scanner.join();
+        if (manifest && manifest->skipped() > 0) {
+            // Nada cambió; el manifiesto se reescribe igual para olvidar los archivos borrados
+            printLockedStream([&](std::ostream &os){ os << "Sin cambios desde la última corrida: " << manifest->skipped() << " archivos omitidos" << std::endl; });
+            if (!manifest->save()) {
+                printLockedStream([&](std::ostream &os){ os << "Advertencia: No se pudo guardar el manifiesto incremental" << std::endl; });
+            }
+            return;
+        }
         printLockedStream([&](std::ostream &os){ os << "No se encontraron archivos para procesar en: " << input_path << std::endl; });
         return;
     }
 
-    runThreadPool(tasks, operations, comp_algorithm, enc_algorithm, key, input_path);
+    runThreadPool(queue, totals, manifest.get(), folder, operations, comp_algorithm, enc_algorithm, key, input_path, output_path);
+    if (scanner.joinable()) scanner.join();
 }
 
-// Función para validar la clave de encriptación
-bool validateSecureKey(const std::string& key, const std::string& enc_algorithm) {
+// Función para validar la clave de encriptación.
+// Si canPrompt es false (stdin trae los datos) una clave débil se rechaza sin preguntar.
+bool validateSecureKey(const std::string& key, const std::string& enc_algorithm, bool canPrompt = true) {
     // Determinar longitud mínima según el algoritmo
     size_t minLength = 8;
     if (enc_algorithm == "AES" || enc_algorithm == "AES128" || enc_algorithm == "AES-128") {
         minLength = 16; // AES-128 requiere clave de 16 bytes (128 bits)
+    } else if (enc_algorithm == "CHACHA20" || enc_algorithm == "ChaCha20" || enc_algorithm == "CHACHA") {
+        minLength = 16; // La clave se extiende a 32 bytes (256 bits)
     }
     
     // Verificar longitud mínima
@@ -683,6 +832,10 @@ bool validateSecureKey(const std::string& key, const std::string& enc_algorithm)
         if (!hasLower) std::cout << "  - Al menos una letra minúscula\n";
         if (!hasDigit) std::cout << "  - Al menos un número\n";
         if (!hasSpecial) std::cout << "  - Al menos un carácter especial (!@#$%^&*)\n";
+        if (!canPrompt) {
+            std::cout << "No se puede confirmar una clave débil cuando la entrada es stdin (-i -).\n";
+            return false;
+        }
         std::cout << "¿Desea continuar de todas formas? (s/n): ";
         
         std::string response;
@@ -714,6 +867,10 @@ bool validateSecureKey(const std::string& key, const std::string& enc_algorithm)
 
 // Función principal
 int main(int argc, char* argv[]) {
+    // Escribir en un pipe cerrado (una etapa del pipeline que falló, un lector de -o -
+    // que terminó) debe fallar con EPIPE y no terminar el proceso con SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+
     // Verificar argumentos mínimos
     if (argc < 2) {
         std::cout << "Uso: ./FileUtility [operaciones] [opciones]" << std::endl;
@@ -725,6 +882,8 @@ int main(int argc, char* argv[]) {
     std::string comp_algorithm;
     std::string enc_algorithm;
     std::string input_file, output_file, key;
+    std::string cpuList;
+    size_t jobs = 0;
 
     // Parsear los argumentos
     for (int i = 1; i < argc; ++i) {
@@ -743,13 +902,108 @@ int main(int argc, char* argv[]) {
         } else if (std::string(argv[i]) == "-k") {
             key = argv[++i];  // Clave de encriptación/desencriptación (si es necesario)
 
+        } else if (std::string(argv[i]) == "-j") {
+            // Número de hilos de cómputo
+            std::string value = (i + 1 < argc) ? argv[++i] : "";
+            char* end = nullptr;
+            long n = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || n <= 0) {
+                std::cout << "Número de hilos inválido: " << value << std::endl;
+                return 1;
+            }
+            jobs = static_cast<size_t>(n);
+            adaptiveConcurrency = false;
+
+        } else if (std::string(argv[i]) == "--cpus") {
+            cpuList = (i + 1 < argc) ? argv[++i] : "";  // CPUs para los workers, p. ej. 0-7,16-23
+
+        } else if (std::string(argv[i]) == "--pool-queue") {
+            // Cola de tareas del thread pool: steal (work-stealing) o ring (cola compartida)
+            std::string kind = (i + 1 < argc) ? argv[++i] : "";
+            if (kind == "steal") {
+                ThreadPool::setDefaultQueueKind(ThreadPool::QueueKind::WorkStealing);
+            } else if (kind == "ring") {
+                ThreadPool::setDefaultQueueKind(ThreadPool::QueueKind::SharedRing);
+            } else {
+                std::cout << "Cola de tareas no soportada: " << kind << " (use steal o ring)" << std::endl;
+                return 1;
+            }
+
+        } else if (std::string(argv[i]) == "--io-buffer") {
+            // Tamaño de los bloques y buffers de E/S, p. ej. 1M o 256K
+            std::string value = (i + 1 < argc) ? argv[++i] : "";
+            char* end = nullptr;
+            long long n = std::strtoll(value.c_str(), &end, 10);
+            long long unit = 1;
+            if (end && (*end == 'K' || *end == 'k')) unit = 1024, ++end;
+            else if (end && (*end == 'M' || *end == 'm')) unit = 1024 * 1024, ++end;
+            if (value.empty() || *end != '\0' || n <= 0 || n * unit > 256LL * 1024 * 1024) {
+                std::cout << "Tamaño de buffer inválido: " << value << " (ejemplo: 1M, 256K)" << std::endl;
+                return 1;
+            }
+            IoPolicy policy = getIoPolicy();
+            policy.blockSize = static_cast<size_t>(n * unit);
+            policy.streamBufferSize = static_cast<size_t>(n * unit);
+            setIoPolicy(policy);
+
+        } else if (std::string(argv[i]) == "--prefetch") {
+            // Archivos de la cola que se piden al kernel por adelantado (0 = ninguno)
+            std::string value = (i + 1 < argc) ? argv[++i] : "";
+            char* end = nullptr;
+            long n = std::strtol(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || n < 0) {
+                std::cout << "Cantidad de archivos a precargar inválida: " << value << std::endl;
+                return 1;
+            }
+            IoPolicy policy = getIoPolicy();
+            policy.prefetchFiles = static_cast<size_t>(n);
+            setIoPolicy(policy);
+
+        } else if (std::string(argv[i]) == "--direct-io") {
+            setDirectIo(true);  // No dejar los datos del lote en la page cache
+
+        } else if (std::string(argv[i]) == "--no-prealloc") {
+            // No reservar las salidas con fallocate (crecen a medida que se escriben)
+            IoPolicy policy = getIoPolicy();
+            policy.preallocate = false;
+            setIoPolicy(policy);
+
+        } else if (std::string(argv[i]) == "--no-sync") {
+            // Publicar las salidas sin fdatasync: más rápido, pero una caída puede dejarlas a medias
+            IoPolicy policy = getIoPolicy();
+            policy.syncOutputs = false;
+            setIoPolicy(policy);
+
+        } else if (std::string(argv[i]) == "--incremental") {
+            incrementalMode = true;  // Omitir los archivos sin cambios (ver Manifest.h)
+
+        } else if (std::string(argv[i]) == "--incremental-hash") {
+            // Como --incremental, y si cambió el mtime se compara el contenido
+            incrementalMode = true;
+            incrementalHash = true;
+
+        } else if (std::string(argv[i]) == "--io") {
+            // Backend de E/S de los lotes: auto (io_uring si está disponible), uring o sync
+            std::string backend = (i + 1 < argc) ? argv[++i] : "";
+            if (backend == "auto") {
+                setIoBackend(IoBackend::Auto);
+            } else if (backend == "uring") {
+                setIoBackend(IoBackend::Uring);
+            } else if (backend == "sync") {
+                setIoBackend(IoBackend::Sync);
+            } else {
+                std::cout << "Backend de E/S no soportado: " << backend << " (use auto, uring o sync)" << std::endl;
+                return 1;
+            }
+
         } else if (argv[i][0] == '-') {
             // Acumular flags cortas como -c, -e, -ce, -ed, etc.
             std::string opt = argv[i];
-            // Ignorar opciones largas ya detectadas (--comp-alg, --enc-alg) y opciones que toman argumento (-i, -o, -k)
-            if (opt.rfind("--comp-alg", 0) == 0 || opt.rfind("--enc-alg", 0) == 0) {
-                // ya manejadas arriba por igualdad exacta; no acumulamos
-            } else if (opt == "-i" || opt == "-o" || opt == "-k") {
+            // Las opciones largas válidas ya se manejaron arriba por igualdad exacta
+            if (opt.rfind("--", 0) == 0) {
+                std::cout << "Opción no reconocida: " << opt << std::endl;
+                return 1;
+            } else if (opt == "-i" || opt == "-o" || opt == "-k" || opt == "-j") {
                 // serán manejadas en sus ramas correspondientes, no acumulamos
             } else {
                 // quitar el prefijo '-' y concatenar el resto
@@ -766,7 +1020,26 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    // Construir la lista de operaciones en orden y ejecutar encadenadas usando archivos temporales
+    // Ubicación de los workers: con --cpus cada uno se fija a una CPU de la lista,
+    // repartidos entre nodos NUMA; -j fija cuántos hay (por defecto, uno por CPU)
+    if (!cpuList.empty()) {
+        std::vector<int> cpus;
+        if (!parseCpuList(cpuList, cpus)) {
+            std::cout << "Lista de CPUs inválida: " << cpuList << " (ejemplo: 0-3,8,10-11)" << std::endl;
+            return 1;
+        }
+        if (!setWorkerCpus(cpus)) return 1;
+    }
+    if (jobs == 0) jobs = workerCpuCount();
+    if (jobs > 0) ThreadPool::setDefaultThreadCount(jobs);
+
+    // Con -o - stdout transporta los datos: los mensajes y el resumen van a stderr
+    if (output_file == "-") {
+        std::cout.rdbuf(std::cerr.rdbuf());
+    }
+
+    // Construir la lista de operaciones en orden; runPipeline las encadena en memoria
+    // (en el mismo hilo para entradas chicas, con pipes entre hilos para las grandes)
     std::vector<char> ops;
     for (char ch : operation) {
         if (ch == '-') continue;
@@ -794,7 +1067,7 @@ int main(int argc, char* argv[]) {
         }
         
         // Validar que la clave sea segura
-        if (!validateSecureKey(key, enc_algorithm)) {
+        if (!validateSecureKey(key, enc_algorithm, input_file != "-")) {
             std::cout << "Error: La clave no cumple con los requisitos de seguridad.\n";
             return 1;
         }
@@ -0,0 +1,82 @@
+#include "pipeline.h"
+
+#include <memory>
+#include <thread>
+
+// Capacidad de cada pipe entre etapas (el kernel puede limitarla; por defecto 64 KB)
+static constexpr size_t PIPE_BUF_SIZE = 1024 * 1024;
+
+// Por debajo de este tamaño de entrada las etapas se encadenan en el hilo llamador:
+// crear un hilo y un pipe por etapa cuesta más que lo que se gana solapándolas
+static constexpr long long INLINE_MAX_SIZE = 16LL * 1024 * 1024;
+
+// Encadena las transformaciones de las etapas en el hilo actual
+static bool runInline(ByteSource &source, ByteSink &sink, const std::vector<PipelineStage> &stages) {
+    std::vector<std::unique_ptr<StreamTransform>> owned;
+    std::vector<StreamTransform*> transforms;
+    for (const PipelineStage &stage : stages) {
+        owned.push_back(stage.transform());
+        transforms.push_back(owned.back().get());
+    }
+    return runTransformChain(source, transforms, sink);
+}
+
+bool runPipeline(ByteSource &source, ByteSink &sink, const std::vector<PipelineStage> &stages,
+                 WorkerMemory* memory) {
+    if (stages.empty()) return true;
+
+    // Los pools se obtienen aquí, en el hilo dueño de 'memory', antes de lanzar las etapas
+    std::vector<BufferPool*> pools(stages.size());
+    for (size_t i = 0; i < stages.size(); ++i) {
+        pools[i] = memory ? &memory->stage(i) : nullptr;
+    }
+
+    if (stages.size() == 1) {
+        BufferPoolScope scope(pools[0] ? *pools[0] : BufferPool::current());
+        return stages[0].run(source, sink);
+    }
+
+    long long size = source.size();
+    bool inlineable = size >= 0 && size < INLINE_MAX_SIZE;
+    for (const PipelineStage &stage : stages) inlineable = inlineable && stage.transform;
+    if (inlineable) {
+        // Un solo hilo: todas las tablas salen de la arena de la primera etapa
+        BufferPoolScope scope(pools[0] ? *pools[0] : BufferPool::current());
+        return runInline(source, sink, stages);
+    }
+
+    // Crear un pipe entre cada par de etapas consecutivas
+    const size_t links = stages.size() - 1;
+    std::vector<std::unique_ptr<PipeSource>> readEnds(links);
+    std::vector<std::unique_ptr<PipeSink>> writeEnds(links);
+    for (size_t i = 0; i < links; ++i) {
+        if (!createPipe(readEnds[i], writeEnds[i], PIPE_BUF_SIZE)) return false;
+    }
+
+    // Cada etapa cierra sus extremos al terminar: el cierre del de escritura es el
+    // EOF para la siguiente y el del de lectura desbloquea a la anterior si hubo error
+    std::vector<char> results(stages.size(), 0);
+    auto runStage = [&](size_t i) {
+        ByteSource &in = (i == 0) ? source : *readEnds[i - 1];
+        ByteSink &out = (i == links) ? sink : *writeEnds[i];
+        {
+            BufferPoolScope scope(pools[i] ? *pools[i] : BufferPool::current());
+            results[i] = stages[i].run(in, out) ? 1 : 0;
+        }
+        if (i > 0) readEnds[i - 1]->close();
+        if (i < links) writeEnds[i]->close();
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(links);
+    for (size_t i = 0; i < links; ++i) {
+        workers.emplace_back(runStage, i);
+    }
+    runStage(links); // la última etapa corre en el hilo llamador
+    for (auto &t : workers) t.join();
+
+    for (char ok : results) {
+        if (!ok) return false;
+    }
+    return true;
+}
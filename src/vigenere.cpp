@@ -0,0 +1,169 @@
+#include "vigenere.h"
+
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VIG_HAVE_X86 1
+#endif
+
+// Normaliza una letra de la clave a valor 0-25 (A/a=0, B/b=1, etc.)
+static int getKeyValue(char c) {
+	if (c >= 'A' && c <= 'Z') return c - 'A';
+	if (c >= 'a' && c <= 'z') return c - 'a';
+	return 0;
+}
+
+VigenereTable vigenereBuildTable(const std::string &key, bool decrypt) {
+	VigenereTable table;
+	table.keyLen = key.size();
+	table.shifts.resize(key.size() + 32);
+	for (std::size_t i = 0; i < table.shifts.size(); ++i) {
+		int k = getKeyValue(key[i % key.size()]);
+		table.shifts[i] = static_cast<uint8_t>(decrypt ? (26 - k) % 26 : k);
+	}
+	return table;
+}
+
+// --- Kernel escalar ---
+
+static void vigenereScalar(const VigenereTable &table, const uint8_t* in, uint8_t* out,
+                           std::size_t n, std::size_t &keyPos) {
+	const uint8_t* shifts = table.shifts.data();
+	std::size_t p = keyPos;
+	for (std::size_t i = 0; i < n; ++i) {
+		uint8_t ch = in[i];
+		uint8_t base;
+		if (ch >= 'A' && ch <= 'Z') base = 'A';
+		else if (ch >= 'a' && ch <= 'z') base = 'a';
+		else { out[i] = ch; continue; }
+
+		unsigned v = static_cast<unsigned>(ch - base) + shifts[p];
+		if (v >= 26) v -= 26;
+		out[i] = static_cast<uint8_t>(base + v);
+		if (++p == table.keyLen) p = 0;
+	}
+	keyPos = p;
+}
+
+#ifdef VIG_HAVE_X86
+
+// --- Kernel SSSE3: 16 bytes por iteración ---
+// Para cada máscara de 8 carriles, EXPAND[m][j] es el rango de la letra j dentro del
+// grupo (cuántas letras la preceden) o 0x80 si el carril no es letra. Con pshufb esto
+// reparte desplazamientos consecutivos de la tabla solo en los carriles con letras.
+struct VigExpandTables {
+	alignas(16) uint8_t lo[256][16];
+	alignas(16) uint8_t hi[256][16];
+};
+
+static const VigExpandTables &vigExpandTables() {
+	static const VigExpandTables tables = [] {
+		VigExpandTables t{};
+		for (int m = 0; m < 256; ++m) {
+			int rank = 0;
+			for (int j = 0; j < 16; ++j) { t.lo[m][j] = 0x80; t.hi[m][j] = 0x80; }
+			for (int j = 0; j < 8; ++j) {
+				if (m & (1 << j)) {
+					t.lo[m][j] = static_cast<uint8_t>(rank);
+					t.hi[m][8 + j] = static_cast<uint8_t>(rank);
+					++rank;
+				}
+			}
+		}
+		return t;
+	}();
+	return tables;
+}
+
+__attribute__((target("ssse3,popcnt")))
+static void vigenereSSSE3(const VigenereTable &table, const uint8_t* in, uint8_t* out,
+                          std::size_t n, std::size_t &keyPos) {
+	const VigExpandTables &exp = vigExpandTables();
+	const uint8_t* shifts = table.shifts.data();
+	const std::size_t kLen = table.keyLen;
+	const __m128i upperLo = _mm_set1_epi8('A' - 1), upperHi = _mm_set1_epi8('Z' + 1);
+	const __m128i lowerLo = _mm_set1_epi8('a' - 1), lowerHi = _mm_set1_epi8('z' + 1);
+	const __m128i baseUpper = _mm_set1_epi8('A'), baseLower = _mm_set1_epi8('a');
+	const __m128i twentyFive = _mm_set1_epi8(25), twentySix = _mm_set1_epi8(26);
+
+	std::size_t p = keyPos;
+	std::size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		// Clasificación con máscaras (bytes >= 0x80 son negativos y nunca son letras)
+		__m128i up = _mm_and_si128(_mm_cmpgt_epi8(x, upperLo), _mm_cmplt_epi8(x, upperHi));
+		__m128i lo = _mm_and_si128(_mm_cmpgt_epi8(x, lowerLo), _mm_cmplt_epi8(x, lowerHi));
+		__m128i letters = _mm_or_si128(up, lo);
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(letters));
+		if (mask == 0) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), x);
+			continue;
+		}
+
+		// Desplazamientos de la clave repartidos en los carriles con letras
+		unsigned mLo = mask & 0xFF, mHi = mask >> 8;
+		std::size_t pHi = p + static_cast<std::size_t>(__builtin_popcount(mLo));
+		__m128i kLo = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(shifts + p)),
+		                               _mm_load_si128(reinterpret_cast<const __m128i*>(exp.lo[mLo])));
+		__m128i kHi = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(shifts + pHi)),
+		                               _mm_load_si128(reinterpret_cast<const __m128i*>(exp.hi[mHi])));
+		__m128i k = _mm_or_si128(kLo, kHi);
+
+		// v = (x - base) + k, con resta condicional de 26
+		__m128i base = _mm_or_si128(_mm_and_si128(up, baseUpper), _mm_and_si128(lo, baseLower));
+		__m128i v = _mm_add_epi8(_mm_sub_epi8(x, base), k);
+		v = _mm_sub_epi8(v, _mm_and_si128(_mm_cmpgt_epi8(v, twentyFive), twentySix));
+		__m128i shifted = _mm_add_epi8(v, base);
+		__m128i result = _mm_or_si128(_mm_and_si128(letters, shifted), _mm_andnot_si128(letters, x));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+
+		p += static_cast<std::size_t>(__builtin_popcount(mask));
+		if (p >= kLen) p %= kLen;
+	}
+	keyPos = p;
+	vigenereScalar(table, in + i, out + i, n - i, keyPos);
+}
+
+#endif
+
+std::size_t vigenereCountLetters(const uint8_t* data, std::size_t n) {
+	std::size_t count = 0;
+	std::size_t i = 0;
+#ifdef __SSE2__
+	// SSE2 es base en x86-64: se cuentan 16 bytes por iteración con la misma clasificación
+	const __m128i upperLo = _mm_set1_epi8('A' - 1), upperHi = _mm_set1_epi8('Z' + 1);
+	const __m128i lowerLo = _mm_set1_epi8('a' - 1), lowerHi = _mm_set1_epi8('z' + 1);
+	for (; i + 16 <= n; i += 16) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i up = _mm_and_si128(_mm_cmpgt_epi8(x, upperLo), _mm_cmplt_epi8(x, upperHi));
+		__m128i lo = _mm_and_si128(_mm_cmpgt_epi8(x, lowerLo), _mm_cmplt_epi8(x, lowerHi));
+		count += static_cast<std::size_t>(__builtin_popcount(_mm_movemask_epi8(_mm_or_si128(up, lo))));
+	}
+#endif
+	for (; i < n; ++i) {
+		uint8_t ch = data[i];
+		count += (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z');
+	}
+	return count;
+}
+
+static bool vigenereHasSSSE3() {
+#ifdef VIG_HAVE_X86
+	static const bool has = __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("popcnt");
+	return has;
+#else
+	return false;
+#endif
+}
+
+void vigenereApply(const VigenereTable &table, const uint8_t* in, uint8_t* out,
+                   std::size_t n, std::size_t &keyPos) {
+#ifdef VIG_HAVE_X86
+	if (vigenereHasSSSE3()) {
+		vigenereSSSE3(table, in, out, n, keyPos);
+		return;
+	}
+#endif
+	vigenereScalar(table, in, out, n, keyPos);
+}